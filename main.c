@@ -0,0 +1,45 @@
+/**
+ * @name main.c
+ * @details command line interface of set and relation calculator
+ * @authors Marian Taragel, Georgii Troitckii, Tomas Prokop
+ * @date 4.12.2021
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "setcal_cli.h"
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strncmp(argv[1], "--output=", 9) == 0){
+        if (strcmp(argv[1] + 9, "binary") == 0){
+            setcal_binary_output(1);
+        }
+        else if (strcmp(argv[1] + 9, "text") != 0){
+            fprintf(stderr, "Unknown output format %s!\n", argv[1] + 9);
+            return EXIT_FAILURE;
+        }
+        argc--;
+        argv++;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--batch") == 0){
+        if (!setcal_run_batch(argc - 2, argv + 2)){
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (argc != 2){
+        fprintf(stderr, "Wrong number of arguments!\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!setcal_read_option(argv[1])){
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
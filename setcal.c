@@ -5,43 +5,157 @@
  * @date 4.12.2021
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "setcal.h"
+#include "setcal_cli.h"
 
-#define MAX_STRING_LENGTH 30
 #define MAX_LINES 1000
 
+/// Precision of HyperLogLog sketches, sketch of each set has 2^HLL_PRECISION registers
+#ifndef HLL_PRECISION
+#define HLL_PRECISION 12
+#endif
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+
+/// Number of sets and bitset words in one tile of similarity computation
+#define SIMILARITY_TILE 16
+#define SIMILARITY_WORDS 256
+
+/// Maximum number of operations and operands in nested expression
+#define MAX_EXPRESSION_NODES 256
+
+/// Maximum number of consecutive commands over the same sets executed together
+#define MAX_PLANNED_COMMANDS 64
+
+/// Number of bytes classified at once by line scanner
+#if defined(__AVX2__)
+#define SCAN_BLOCK 32
+#else
+#define SCAN_BLOCK 16
+#endif
+#define SCAN_MASK (unsigned) ((1ULL << SCAN_BLOCK) - 1)
+
+/// Definition sections smaller than this are parsed by the calling thread only
+#ifndef PARALLEL_PARSE_BYTES
+#define PARALLEL_PARSE_BYTES (1 << 20)
+#endif
+
 enum commands {EMPTY, CARD, COMPLEMENT, UNION,
     INTERSECT, MINUS, SUBSETEQ, SUBSET, EQUALS,
     REFLEXIVE, SYMMETRIC, ANTISYMMETRIC, TRANSITIVE,
     FUNCTION, DOMAIN, CODOMAIN, INJECTIVE,
-    SURJECTIVE, BIJECTIVE};
+    SURJECTIVE, BIJECTIVE, PROFILE, ACARD, AUNIONCARD,
+    SIMILARITY, LATTICE, INSERT, ERASE, ADDPAIR, DELPAIR,
+    CONTAINS, CONTAINSALL, CONTAINSANY, IMAGE, PREIMAGE,
+    REACH, REACHABLE, SCC, CONDENSATION, COMPOSE, INVERSE,
+    RUNION, RINTERSECT, RMINUS, RSUBSETEQ, UNIONALL, INTERSECTALL};
+
+/// Primary representations of set, chosen by density of set
+enum set_representations {SET_ARRAY, SET_BITSET, SET_RUNS};
+
+/// Identifiers of commands, order matches enum commands
+static char *command_names[] = {"empty", "card", "complement", "union",
+                                "intersect", "minus", "subseteq", "subset", "equals",
+                                "reflexive", "symmetric", "antisymmetric", "transitive",
+                                "function", "domain", "codomain", "injective",
+                                "surjective", "bijective", "profile", "acard", "aunioncard",
+                                "similarity", "lattice", "insert", "erase", "addpair", "delpair",
+                                "contains", "containsall", "containsany", "image", "preimage",
+                                "reach", "reachable", "scc", "condensation", "compose", "inverse",
+                                "runion", "rintersect", "rminus", "rsubseteq", "unionall", "intersectall"};
+
+#define NUMBER_OF_COMMANDS (int) (sizeof(command_names) / sizeof(command_names[0]))
 
 typedef struct{
     char **elements;
     int cardinality;
     int capacity;
     int position;
+    unsigned char *sketch;
+    int representation;
+    int *ids;                       /// sorted indexes to universe, SET_ARRAY, room for capacity of elements
+    unsigned long long *bitset;     /// SET_BITSET, other sets build it on demand
+    int *runs;                      /// starts and ends of ranges of indexes, SET_RUNS
+    int number_of_runs;             /// number of ranges, kept for every representation
+    unsigned long long hash;        /// hash of content
+    unsigned long long signature;   /// OR of bits chosen by hashes of elements
+    int *references;                /// number of identical sets sharing arrays, NULL - set isn't shared
 } Set;
 
+typedef struct{
+    Set *set;
+    int position;
+    int next;
+    unsigned long long word;
+} Set_cursor;
+
+typedef struct{
+    char* data;
+    size_t size;
+    size_t capacity;
+} String_pool;
+
+typedef struct{
+    unsigned char* data;
+    int length;
+    int capacity;
+    int count;
+    int last;
+} Posting_list;
+
+typedef struct{
+    Posting_list* lists;
+    int size;
+    int built;
+} Inverted_index;
+
 typedef struct{
     Set* sets;
     int size;
     int capacity;
+    String_pool pool;
+    Inverted_index index;
 } Set_list;
 
 typedef struct{
-    char* first;
-    char* second;
-} Pair;
+    unsigned long long key;         /// first << 32 | second
+    int slot;                       /// position in first and second, -1 - pair of adjacency was deleted
+} Pending_pair;
 
 typedef struct{
-    Pair* pairs;
+    int* first;                     /// deleted pairs are marked by -1 until adjacency is built again
+    int* second;
     int number_of_pairs;
+    int deleted;                    /// number of deleted pairs still taking place in first and second
     int position;
     int capacity;
+    int* row_offsets;
+    int* columns;
+    int* slots;                     /// positions of pairs of CSR in first and second
+    int* column_offsets;
+    int* rows;
+    Pending_pair* pending;          /// pairs added or deleted after adjacency was built, sorted by key
+    int number_of_pending;
+    int pending_capacity;
+    unsigned long long hash;        /// hash of content
+    int* references;                /// number of identical relations sharing arrays, NULL - relation isn't shared
 } Relation;
 
 typedef struct{
@@ -50,729 +164,996 @@ typedef struct{
     int capacity;
 } Relation_list;
 
-/// ======================================================================= ///
+typedef struct{
+    int* tasks;
+    int head;
+    int tail;
+    pthread_mutex_t lock;
+} Task_deque;
 
-int str_comparator(const void* s1, const void* s2)
-{
-    return strcmp(*(const char**)s1, *(const char**)s2);
-}
+typedef struct{
+    char** files;
+    int number_of_files;
+    int capacity;
+    Task_deque* deques;
+    int number_of_workers;
+    int failures;
+    pthread_mutex_t lock;
+} Batch;
+
+typedef struct{
+    Batch* batch;
+    int id;
+} Batch_worker;
+
+typedef struct{
+    unsigned long long** bitsets;
+    int* cardinalities;
+    int* intersections;
+    int number_of_sets;
+    int words;
+    int next_tile;
+    pthread_mutex_t lock;
+} Similarity;
+
+typedef struct{
+    int operation;
+    int left;
+    int right;
+    unsigned long long* bitset;
+} Expression_node;
+
+typedef struct{
+    Expression_node nodes[MAX_EXPRESSION_NODES];
+    int size;
+    char* cursor;
+    Set_list* set_list;
+} Expression;
+
+typedef struct{
+    int commands[MAX_PLANNED_COMMANDS];
+    int swapped[MAX_PLANNED_COMMANDS];
+    int first;
+    int second;
+    int size;
+} Command_plan;
+
+typedef struct{
+    unsigned long long *items;
+    int size;
+    int capacity;
+    char kind;
+    String_pool bytes;
+    int failed;         /// part of record couldn't be stored
+} Record;
+
+typedef struct{
+    Setcal_result *result;  /// NULL - results are printed
+    size_t length;          /// length of text of result
+    size_t capacity;        /// size of buffer of text
+    int failed;             /// part of result couldn't be stored
+} Capture;
+
+typedef struct{
+    unsigned long long* blanks;
+    unsigned long long* closing;
+    size_t length;
+    int alphabetic;
+} Line_scan;
+
+typedef struct{
+    char** lines;
+    char* kinds;
+    Set* sets;
+    Relation* relations;
+    int* parsed;
+    char** errors;      /// messages of wrong lines
+    int number_of_lines;
+    int capacity;
+    int first_row;
+    int next_line;
+    Set_list* set_list;
+    pthread_mutex_t lock;
+} Definitions;
+
+struct setcal{
+    Set_list set_list;
+    Relation_list relation_list;
+    Command_plan plan;
+    String_pool line;
+    int rows;
+};
+
+/// Stream for results of the current input file, each batch worker has its own
+static __thread FILE *output_file = NULL;
+
+/// Results are written as binary records instead of text (--output=binary)
+static int binary_output = 0;
+
+/// Binary record being assembled by the calling thread
+static __thread Record record = {NULL, 0, 0, 0, {NULL, 0, 0}, 0};
+
+/// Stream for error messages of the calling thread, parsing workers keep them per line
+static __thread FILE *error_file = NULL;
+
+/// Batch workers occupy all processors, so sections are parsed by one thread
+static int batch_running = 0;
+
+/// Result of library call filled by the calling thread
+static __thread Capture capture = {NULL, 0, 0, 0};
 
 /// ======================================================================= ///
 
 /**
- * Constructor for set
+ * Function returns stream for results of the current input file
  *
- * @param[in] set
+ * @return output stream of the calling thread, stdout by default
  */
-void set_ctor(Set *set, int current_row)
+static FILE *output(void)
 {
-    set->elements = NULL;
-    set->cardinality = 0;
-    set->capacity = 0;
-    set->position = current_row;
+    if (output_file == NULL){
+        return stdout;
+    }
+    return output_file;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function free resources for set
+ * Function returns stream for error messages of parsing
  *
- * @param[in] set
+ * @return error stream of the calling thread, stderr by default
  */
-void free_set(Set* set)
+static FILE *error_output(void)
 {
-    for (int i = 0; i < set->cardinality; ++i) {
-        if (set->elements[i] != NULL){
-            free(set->elements[i]);
-            set->elements[i] = NULL;
-        }
-        set->elements[i] = NULL;
-    }
-    if (set->elements != NULL){
-        free(set->elements);
-        set->elements = NULL;
+    if (error_file == NULL){
+        return stderr;
     }
-    set->elements = NULL;
-    set->cardinality = 0;
-    set->capacity = 0;
-    set->position = 0;
+    return error_file;
 }
 
 /// ======================================================================= ///
 
-/**
- * Constructor for list of sets
- *
- * @param[in] set_list
- */
-void set_list_ctor(Set_list* set_list)
+static int str_comparator(const void* s1, const void* s2)
 {
-    set_list->sets = NULL;
-    set_list->capacity = 0;
-    set_list->size = 0;
+    return strcmp(*(const char**)s1, *(const char**)s2);
 }
 
 /// ======================================================================= ///
 
-/**
- * Function free resources for list of sets
- *
- * @param[in] set_list
- */
-void free_set_list(Set_list* set_list)
+static int int_comparator(const void* i1, const void* i2)
 {
-    for (int i = 0; i < set_list->size; ++i) {
-        free_set(&set_list->sets[i]);
-    }
-    if (set_list->sets != NULL) {
-        free(set_list->sets);
-        set_list->sets = NULL;
-    }
-    set_list->size = 0;
-    set_list->capacity = 0;
+    int int_1 = *(const int*)i1;
+    int int_2 = *(const int*)i2;
+    return (int_1 > int_2) - (int_1 < int_2);
 }
 
 /// ======================================================================= ///
 
-/**
- * Constructor for pair
- *
- * @param[in] pair
- */
-void pair_ctor(Pair *pair)
+static int key_comparator(const void* k1, const void* k2)
 {
-    pair->first = NULL;
-    pair->second = NULL;
+    unsigned long long key_1 = *(const unsigned long long*)k1;
+    unsigned long long key_2 = *(const unsigned long long*)k2;
+    return (key_1 > key_2) - (key_1 < key_2);
 }
 
 /// ======================================================================= ///
 
 /**
- *  Function free resources for pair
+ * Constructor for string pool
  *
- * @param[in] pair
+ * @param[in] pool
  */
-void free_pair(Pair *pair)
+static void pool_ctor(String_pool *pool)
 {
-    if ((pair->first != NULL) && (pair->second != NULL)){
-        free(pair->first);
-        pair->first = NULL;
-        free(pair->second);
-        pair->second = NULL;
-    }
+    pool->data = NULL;
+    pool->size = 0;
+    pool->capacity = 0;
 }
 
 /// ======================================================================= ///
 
 /**
- * Constructor for relation
+ * Function free resources for string pool
  *
- * @param[in] relation
+ * @param[in] pool
  */
-void relation_ctor(Relation *relation, int current_row)
+static void free_pool(String_pool *pool)
 {
-    relation->pairs = NULL;
-    relation->number_of_pairs = 0;
-    relation->capacity = 0;
-    relation->position = current_row;
+    if (pool->data != NULL){
+        free(pool->data);
+        pool->data = NULL;
+    }
+    pool->size = 0;
+    pool->capacity = 0;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function free resources for relation
+ * Function appends character to the end of string pool
  *
- * @param[in] relation
+ * @param[in] pool
+ * @param[in] c
+ * @return 0 - not enough memory, 1 - in other case
  */
-void free_relation(Relation *relation)
+static int pool_push(String_pool *pool, char c)
 {
-    for (int i = 0; i < relation->number_of_pairs; i++){
-        free_pair(&relation->pairs[i]);
-    }
-
-    if (relation->pairs != NULL) {
-        free(relation->pairs);
-        relation->pairs = NULL;
+    if (pool->size == pool->capacity){
+        size_t capacity = pool->capacity ? pool->capacity * 2 : 256;
+        char *temp = (char *) realloc(pool->data, capacity);
+        if (temp == NULL){
+            fprintf(error_output(), "Not enough memory!\n");
+            return 0;
+        }
+        pool->data = temp;
+        pool->capacity = capacity;
     }
+    pool->data[pool->size++] = c;
 
-    relation->pairs = 0;
-    relation->position = 0;
+    return 1;
 }
 
 /// ======================================================================= ///
 
 /**
- * Constructor for list of pairs
+ * Function appends string with terminating null to the end of string pool
  *
- * @param[in] relation_list
+ * @param[in] pool
+ * @param[in] string
+ * @return 0 - not enough memory, 1 - in other case
  */
-void relation_list_ctor(Relation_list *relation_list)
+static int pool_append(String_pool *pool, const char *string)
 {
-    relation_list->relations = NULL;
-    relation_list->size = 0;
-    relation_list->capacity = 0;
+    do {
+        if (!pool_push(pool, *string)){
+            return 0;
+        }
+    } while (*string++ != '\0');
+
+    return 1;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function free resources for relation_list
+ * Function finds index of element in sorted universe
  *
- * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] element
+ * @return index of element, -1 if element isn't in universe
  */
-void free_relation_list(Relation_list *relation_list)
+static int universe_index(Set_list *set_list, char *element)
 {
-    for (int i = 0; i < relation_list->size; i++){
-        free_relation(&relation_list->relations[i]);
-    }
-
-    if (relation_list->relations != NULL){
-        free(relation_list->relations);
-        relation_list->relations = NULL;
+    char **found = (char **) bsearch(&element, set_list->sets[0].elements, set_list->sets[0].cardinality,
+                                     sizeof(char *), str_comparator);
+    if (found == NULL){
+        return -1;
     }
 
-    relation_list->size = 0;
-    relation_list->capacity = 0;
+    return (int) (found - set_list->sets[0].elements);
 }
 
 /// ======================================================================= ///
 
 /**
- * Function to add element to set
+ * Function appends byte to record, lost byte marks record as failed
  *
- * @param[in] set
- * @param[in] elem
- * @param[in] elem_length
- * @return 0 error, 1 in other case
+ * @param[in] c
  */
-int add_element_to_set(Set *set, char* elem, int elem_length)
+static void record_byte(char c)
 {
-    for (int i = 0; i < set->cardinality; i++){
-        if (strcmp(set->elements[i], elem) == 0){
-            fprintf(stderr, "Element was already stored!\n");
-            return 0;
-        }
-    }
-
-    if (set->elements == NULL){
-        set->capacity = 10;
-        set->elements = (char**) malloc(sizeof(char*) * set->capacity);
-        set->cardinality = 1;
-        set->elements[0] = (char*) malloc(elem_length + 1);
-    }
-    else {
-        char** temp = NULL;
-        set->cardinality++;
-
-        if ( set->cardinality > set->capacity){
-            set->capacity *= 2;
-            temp = (char**) realloc(set->elements, sizeof(char*) * set->cardinality);
-            if (temp == NULL) {
-                free_set(set);
-                fprintf(stderr, "Not enough memory!\n");
-                return 0;
-            }
-            set->elements = temp;
-        }
-        set->elements[set->cardinality - 1] = (char*) malloc(elem_length + 1);
+    if (!pool_push(&record.bytes, c)){
+        record.failed = 1;
     }
-
-    memcpy(set->elements[set->cardinality - 1], elem, elem_length + 1);
-
-    return 1;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function add set to list
+ * Function appends unsigned number to bytes of record as varint
  *
- * @param[in] set_list
- * @param[in] new_set set, that will be added to list
+ * @param[in] value
  */
-int add_set_to_list(Set_list* set_list, Set* new_set)
+static void record_varint(unsigned long long value)
 {
-    if (set_list->sets == NULL){
-        set_list->size = 1;
-        set_list->capacity = 10;
-        set_list->sets = (Set*) malloc(sizeof(Set) * set_list->capacity);
-    }
-    else {
-        Set* temp = NULL;
-        set_list->size++;
-        if ( set_list->size > set_list->capacity ){
-            set_list->capacity *=2;
-            temp = (Set*) realloc(set_list->sets, sizeof(Set) * set_list->capacity);
-            if (temp == NULL){
-                free_set_list(set_list);
-                fprintf(stderr, "Not enough memory!\n");
-                return 0;
-            }
-            set_list->sets = temp;
-        }
+    while (value >= 0x80){
+        record_byte((char) (value | 0x80));
+        value >>= 7;
     }
-    set_list->sets[set_list->size - 1] = *new_set;
-    return 1;
+    record_byte((char) value);
 }
 
 /// ======================================================================= ///
 
 /**
- * Function to add element to set
+ * Function appends item (element index or packed pair) to current record
  *
- * @param[in] set
- * @param[in] elem
- * @param[in] elem_length
+ * @param[in] item
  */
-int add_elements_to_pair(Pair *pair, char *first, char *second, int first_length, int second_length)
+static void record_item(unsigned long long item)
 {
-    if ((pair->first == NULL) && (pair->second == NULL)){
-        pair->first = (char *) malloc(sizeof(char) * (first_length + 1));
-        if (pair->first == NULL){
-            fprintf(stderr, "Not enough memory!\n");
-            return 0;
-        }
-        strcpy(pair->first, first);
-
-        pair->second = (char *) malloc(sizeof(char) * (second_length + 1));
-        if (pair->first == NULL){
+    if (record.size == record.capacity){
+        int capacity = record.capacity ? record.capacity * 2 : 64;
+        unsigned long long *temp = (unsigned long long *) realloc(record.items, sizeof(unsigned long long) * capacity);
+        if (temp == NULL){
             fprintf(stderr, "Not enough memory!\n");
-            return 0;
+            record.failed = 1;
+            return;
         }
-        strcpy(pair->second, second);
-    }
-    else {
-        fprintf(stderr, "Not enough memory!\n");
-        return 0;
+        record.items = temp;
+        record.capacity = capacity;
     }
-
-    return 1;
+    record.items[record.size++] = item;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function add pair to relation
+ * Function writes record as type, varint length and payload.
+ * Incomplete record isn't written, failure is reported by check_record.
  *
- * @param[in] relation
- * @param[in] pair
+ * @param[in] type
  */
-int add_pair_to_relation(Relation *relation, Pair *pair)
+static void write_record(char type)
 {
-    if (relation->capacity == relation->number_of_pairs){
-        if (relation->pairs == NULL){
-            relation->capacity = 10;
-            relation->pairs = (Pair *) malloc(sizeof(Pair) * relation->capacity);
-            if (relation->pairs == NULL){
-                fprintf(stderr, "Not enough memory!\n");
-                return 0;
-            }
-        }
-        else {
-            relation->capacity += 5;
-            Pair *pointer;
-            pointer = (Pair *) realloc(relation->pairs, sizeof(Pair) * relation->number_of_pairs);
-            if (pointer == NULL){
-                fprintf(stderr, "Not enough memory!\n");
-                return 0;
-            }
-            relation->pairs = pointer;
-        }
+    String_pool payload = record.bytes;
+    FILE *file = output();
+
+    if (record.failed){
+        record.bytes.size = 0;
+        record.size = 0;
+        return;
     }
 
-    relation->number_of_pairs++;
-    relation->pairs[relation->number_of_pairs - 1] = *pair;
+    fputc(type, file);
+    unsigned long long length = payload.size;
+    while (length >= 0x80){
+        fputc((int) ((length & 0x7F) | 0x80), file);
+        length >>= 7;
+    }
+    fputc((int) length, file);
+    fwrite(payload.data, 1, payload.size, file);
 
-    return 1;
+    record.bytes.size = 0;
+    record.size = 0;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function add relation to list of relations
+ * Function checks whether all records were written and clears the failure
  *
- * @param[in] relation_list
- * @param[in] relation relation, that will be added to list
+ * @return 0 - some record was lost because of lack of memory, 1 - in other case
  */
-int add_relation_to_list(Relation_list *relation_list, Relation *relation)
+static int check_record(void)
 {
-    if (relation_list->capacity == relation_list->size){
-        if (relation_list->relations == NULL){
-            relation_list->capacity = 10;
-            relation_list->relations = (Relation *) malloc(sizeof(Relation) * relation_list->capacity);
-            if (relation_list->relations == NULL){
-                fprintf(stderr, "Not enough memory!\n");
-                return 0;
-            }
-        }
-        else {
-            relation_list->capacity += 5;
-            Relation *pointer;
-            pointer = (Relation *) realloc(relation_list->relations, sizeof(Relation) * relation_list->capacity);
-            if (pointer == NULL){
-                fprintf(stderr, "Not enough memory!\n");
-                return 0;
-            }
-            relation_list->relations = pointer;
-        }
-    }
-    relation_list->size++;
-    relation_list->relations[relation_list->size - 1] = *relation;
+    int failed = record.failed;
+    record.failed = 0;
 
-    return 1;
+    return !failed;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function print set on stdout
+ * Function free buffers of binary records of the calling thread
+ */
+static void free_record(void)
+{
+    free_pool(&record.bytes);
+    free(record.items);
+    record.items = NULL;
+    record.size = 0;
+    record.capacity = 0;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function appends element of set or pair of relation to captured result
  *
- * @param[in] set set to print
+ * @param[in] first - index of element or of first element of pair
+ * @param[in] second - index of second element of pair
  */
-void print_set(Set_list *set_list, Set set)
+static void capture_item(int first, int second)
 {
-    if (set_list->size == 1){
-        printf("U");
-    }
-    else {
-        printf("S");
+    if ((capture.result->size + 1) * 2 > capture.result->capacity){
+        int capacity = capture.result->capacity ? capture.result->capacity * 2 : 64;
+        int *temp = (int *) realloc(capture.result->elements, sizeof(int) * capacity);
+        if (temp == NULL){
+            fprintf(stderr, "Not enough memory!\n");
+            capture.failed = 1;
+            return;
+        }
+        capture.result->elements = temp;
+        capture.result->capacity = capacity;
     }
 
-    if (set.cardinality == 0){
-        printf("\n");
+    if (capture.result->kind == RESULT_RELATION){
+        capture.result->elements[capture.result->size * 2] = first;
+        capture.result->elements[capture.result->size * 2 + 1] = second;
     }
     else {
-        for (int i = 0; i < set.cardinality; i++){
-            printf(" %s", set.elements[i]);
-        }
-        printf("\n");
+        capture.result->elements[capture.result->size] = first;
     }
+    capture.result->size++;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function print relation on stdout
+ * Function starts printing of set
  *
- * @param[in] relation relation to print
+ * @param[in] prefix - 'S' for set, 'U' for universe
  */
-void print_relation(Relation relation)
+static void emit_set_begin(char prefix)
 {
-    if (relation.number_of_pairs == 0){
-        printf("R\n");
+    if (capture.result != NULL){
+        capture.result->kind = RESULT_SET;
+        capture.result->size = 0;
+        return;
     }
-    else {
-        printf("R");
-        for (int i = 0; i < relation.number_of_pairs; i++){
-            printf(" (%s %s)", relation.pairs[i].first, relation.pairs[i].second);
-        }
-        printf("\n");
+    if (!binary_output){
+        fprintf(output(), "%c", prefix);
+        return;
     }
+    record.kind = prefix;
+    record.size = 0;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function find index of set on given row
+ * Function prints element of set given by index in universe
  *
  * @param[in] set_list
- * @param[in] row
- * @return 0 - there isn't set on the row, 1 in other case
+ * @param[in] index
  */
-int check_set_existence(Set_list* set_list, int* row)
+static void emit_element(Set_list *set_list, int index)
 {
-    for (int i = 0; i < set_list->size; i++) {
-        if (set_list->sets[i].position == *row){
-            *row = i;
-            return 1;
-        }
+    if (capture.result != NULL){
+        capture_item(index, 0);
+        return;
     }
-    return 0;
+    if (!binary_output){
+        fprintf(output(), " %s", set_list->sets[0].elements[index]);
+        return;
+    }
+    record_item(index);
 }
 
 /// ======================================================================= ///
 
 /**
- * Function find index of relation on given row
+ * Function prints element of set given by name
  *
- * @param[in] rel_list
- * @param[in] row
- * @return 0 - there isn't relation on the row, 1 in other case
+ * @param[in] set_list
+ * @param[in] name
  */
-int check_relation_existence(Relation_list* rel_list, int* row)
+static void emit_name(Set_list *set_list, char *name)
 {
-    for (int i = 0; i < rel_list->size; ++i) {
-        if (rel_list->relations[i].position == *row){
-            *row = i;
-            return 1;
-        }
+    if (capture.result != NULL){
+        capture_item(universe_index(set_list, name), 0);
+        return;
     }
-    return 0;
+    if (!binary_output){
+        fprintf(output(), " %s", name);
+        return;
+    }
+    record_item(universe_index(set_list, name));
 }
 
 /// ======================================================================= ///
 
 /**
- * Function compares two pairs in relation
+ * Function finishes printing of set. Universe is written as dictionary of
+ * names, other sets as varint deltas of sorted indexes or as bitmap,
+ * whichever is shorter.
  *
- * @param[in] pair_1
- * @param[in] pair_2
- * @return 1 - pairs are identical, 0 - in other case
+ * @param[in] set_list
  */
-int compare_pairs(Pair pair_1, Pair pair_2)
+static void emit_set_end(Set_list *set_list)
 {
-    int match_1 = strcmp(pair_1.first, pair_2.first);
-    int match_2 = strcmp(pair_1.second, pair_2.second);
-    if (match_1 || match_2){
-        return 0;
+    if (capture.result != NULL){
+        return;
+    }
+    if (!binary_output){
+        fprintf(output(), "\n");
+        return;
     }
 
-    return 1;
+    if (record.kind == 'U'){
+        /// Dictionary of universe starts the output
+        fwrite("SCB1", 1, 4, output());
+        record_varint(set_list->sets[0].cardinality);
+        for (int i = 0; i < set_list->sets[0].cardinality; i++){
+            char *name = set_list->sets[0].elements[i];
+            size_t length = strlen(name);
+            record_varint(length);
+            for (size_t j = 0; j < length; j++){
+                record_byte(name[j]);
+            }
+        }
+        write_record('U');
+        return;
+    }
+
+    qsort(record.items, record.size, sizeof(unsigned long long), key_comparator);
+
+    unsigned long long delta_size = 0;
+    for (int i = 0; i < record.size; i++){
+        unsigned long long delta = record.items[i] - (i ? record.items[i - 1] : 0);
+        do {
+            delta_size++;
+            delta >>= 7;
+        } while (delta);
+    }
+    unsigned long long bitmap_size = (set_list->sets[0].cardinality + 7) / 8;
+
+    if (delta_size <= bitmap_size){
+        record_byte(0);
+        record_varint(record.size);
+        for (int i = 0; i < record.size; i++){
+            record_varint(record.items[i] - (i ? record.items[i - 1] : 0));
+        }
+    }
+    else {
+        record_byte(1);
+        size_t start = record.bytes.size;
+        for (unsigned long long i = 0; i < bitmap_size; i++){
+            record_byte(0);
+        }
+        for (int i = 0; i < record.size; i++){
+            record.bytes.data[start + record.items[i] / 8] |= (char) (1 << (record.items[i] % 8));
+        }
+    }
+    write_record('S');
 }
 
 /// ======================================================================= ///
 
 /**
- * Function find pair in array of pairs
- *
- * @param[in] pairs
- * @param[in] pair
- * @param[in] size
- * @return 1 - pair found, 0 - in other case
+ * Function starts printing of relation
  */
-int find_pair(Pair *pairs, Pair pair, int size)
+static void emit_relation_begin(void)
 {
-    for (int i = 0; i < size; i++){
-        if (compare_pairs(pairs[i], pair)){
-            return 1;
-        }
+    if (capture.result != NULL){
+        capture.result->kind = RESULT_RELATION;
+        capture.result->size = 0;
+        return;
     }
-
-    return 0;
+    if (!binary_output){
+        fprintf(output(), "R");
+        return;
+    }
+    record.kind = 'R';
+    record.size = 0;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function find domain or codomain of relation
+ * Function prints pair of relation given by indexes in universe
  *
- * @param[in] relation_list
- * @param[in] row_number
- * @param[in] codomain_flag 0 - find domain, 1 - find codomain
- * @return 0 - there isn't relation on the row, 1 in other case
+ * @param[in] set_list
+ * @param[in] first
+ * @param[in] second
  */
-int domain_or_codomain(Relation_list* relation_list, int row_number, int codomain_flag)
+static void emit_pair(Set_list *set_list, int first, int second)
 {
-    if (!check_relation_existence(relation_list, &row_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    if (capture.result != NULL){
+        capture_item(first, second);
+        return;
     }
-
-    int size_of_relation = relation_list->relations[row_number].number_of_pairs;
-
-    if (size_of_relation == 0){
-        printf("S\n");
-        return 1;
+    if (!binary_output){
+        fprintf(output(), " (%s %s)", set_list->sets[0].elements[first], set_list->sets[0].elements[second]);
+        return;
     }
+    record_item(((unsigned long long) first << 32) | (unsigned long long) second);
+}
 
-    Pair *pairs = relation_list->relations[row_number].pairs;
-    char *elements[size_of_relation];
+/// ======================================================================= ///
 
-    if (codomain_flag){
-        for (int i = 0; i < size_of_relation; i++){
-            elements[i] = pairs[i].second;
-        }
+/**
+ * Function finishes printing of relation, pairs are sorted and written
+ * as deltas of first elements and of second elements with the same first
+ */
+static void emit_relation_end(void)
+{
+    if (capture.result != NULL){
+        return;
     }
-    else {
-        for (int i = 0; i < size_of_relation; i++){
-            elements[i] = pairs[i].first;
-        }
+    if (!binary_output){
+        fprintf(output(), "\n");
+        return;
     }
 
-    qsort(elements, size_of_relation, sizeof(char*), str_comparator);
-
-    /// prints distinct elements
-    printf("S");
-    for (int i = 0; i < size_of_relation; ++i) {
-        while ((i < size_of_relation - 1) && (strcmp(elements[i], elements[i + 1]) == 0)){
-            i++;
-        }
-        printf(" %s", elements[i]);
+    qsort(record.items, record.size, sizeof(unsigned long long), key_comparator);
+
+    record_varint(record.size);
+    unsigned long long previous_first = 0;
+    unsigned long long previous_second = 0;
+    for (int i = 0; i < record.size; i++){
+        unsigned long long first = record.items[i] >> 32;
+        unsigned long long second = record.items[i] & 0xFFFFFFFFULL;
+        record_varint(first - previous_first);
+        record_varint(first == previous_first && i > 0 ? second - previous_second : second);
+        previous_first = first;
+        previous_second = second;
     }
-    printf("\n");
-
-    return 1;
+    write_record('R');
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - relation is function
- * false - in other case
+ * Function prints true or false
  *
- * @param[in] relation_list
- * @param[in] row_number
- * @return 0 - there isn't relation on the row, 1 - in other case
+ * @param[in] value
  */
-int is_function(Relation_list *relation_list, int row_number)
+static void emit_bool(int value)
 {
-    if (!check_relation_existence(relation_list, &row_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    if (capture.result != NULL){
+        capture.result->kind = RESULT_BOOL;
+        capture.result->value = value != 0;
+        return;
     }
+    if (!binary_output){
+        fprintf(output(), value ? "true\n" : "false\n");
+        return;
+    }
+    record_byte((char) (value != 0));
+    write_record('B');
+}
 
-    int size_of_relation = relation_list->relations[row_number].number_of_pairs;
+/// ======================================================================= ///
 
-    if (size_of_relation == 0){
-        printf("true\n");
-        return 1;
+/**
+ * Function prints natural number
+ *
+ * @param[in] value
+ */
+static void emit_number(unsigned long long value)
+{
+    if (capture.result != NULL){
+        capture.result->kind = RESULT_NUMBER;
+        capture.result->value = value;
+        return;
     }
+    if (!binary_output){
+        fprintf(output(), "%llu\n", value);
+        return;
+    }
+    record_varint(value);
+    write_record('N');
+}
 
-    Pair *pairs = relation_list->relations[row_number].pairs;
-    char *elements[size_of_relation];
+/// ======================================================================= ///
 
-    for (int i = 0; i < size_of_relation; i++){
-        elements[i] = pairs[i].first;
+/**
+ * Function prints free-form result, binary record is written
+ * at the end of line
+ *
+ * @param[in] format
+ */
+static void emit_text(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    if (capture.result == NULL && !binary_output){
+        vfprintf(output(), format, args);
+        va_end(args);
+        return;
     }
 
-    qsort(elements, size_of_relation, sizeof(char*), str_comparator);
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
 
-    for (int i = 0; i < size_of_relation; ++i) {
-        if ((i < size_of_relation - 1) && (strcmp(elements[i], elements[i + 1]) == 0)){
-            printf("false\n");
-            return 1;
+    char text[length + 1];
+    vsnprintf(text, length + 1, format, args);
+    va_end(args);
+
+    if (capture.result != NULL){
+        if (capture.length + length + 1 > capture.capacity){
+            size_t capacity = capture.capacity ? capture.capacity : 64;
+            while (capture.length + length + 1 > capacity){
+                capacity *= 2;
+            }
+            char *temp = (char *) realloc(capture.result->text, capacity);
+            if (temp == NULL){
+                fprintf(stderr, "Not enough memory!\n");
+                capture.failed = 1;
+                return;
+            }
+            capture.result->text = temp;
+            capture.capacity = capacity;
         }
+        memcpy(capture.result->text + capture.length, text, length + 1);
+        capture.length += length;
+        capture.result->kind = RESULT_TEXT;
+        return;
     }
-    printf("true\n");
 
-    return 1;
+    for (int i = 0; i < length; i++){
+        if (text[i] == '\n'){
+            write_record('T');
+        }
+        else {
+            record_byte(text[i]);
+        }
+    }
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - relation is reflexive
- * false - in other case
+ * Function free resources for inverted index
  *
- * @param[in] relation_list
- * @param[in] set_list
- * @param[in] row_number
- * @return 0 - there isn't relation on the row, 1 - in other case
+ * @param[in] index
  */
-int is_reflexive(Relation_list *relation_list, Set_list *set_list, int row_number)
+static void free_inverted_index(Inverted_index *index)
 {
-    if (!check_relation_existence(relation_list, &row_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    if (index->lists != NULL){
+        for (int i = 0; i < index->size; i++){
+            free(index->lists[i].data);
+        }
+        free(index->lists);
+        index->lists = NULL;
     }
+    index->size = 0;
+    index->built = 0;
+}
 
-    char **elements = set_list->sets[0].elements;
-    int size_of_universe = set_list->sets[0].cardinality;
-    Pair *pairs = relation_list->relations[row_number].pairs;
-    int size_of_relation = relation_list->relations[row_number].number_of_pairs;
+/// ======================================================================= ///
 
-    for (int i = 0; i < size_of_universe; i++){
-        char *element = elements[i];
-        Pair pair;
-        pair.first = element;
-        pair.second = element;
+/**
+ * Constructor for set
+ *
+ * @param[in] set
+ */
+static void set_ctor(Set *set, int current_row)
+{
+    set->elements = NULL;
+    set->cardinality = 0;
+    set->capacity = 0;
+    set->position = current_row;
+    set->sketch = NULL;
+    set->representation = SET_ARRAY;
+    set->ids = NULL;
+    set->bitset = NULL;
+    set->runs = NULL;
+    set->number_of_runs = 0;
+    set->hash = 0;
+    set->signature = 0;
+    set->references = NULL;
+}
 
-        if (!find_pair(pairs, pair, size_of_relation)){
-            printf("false\n");
-            return 1;
-        }
+/// ======================================================================= ///
+
+/**
+ * Function free resources for set
+ *
+ * @param[in] set
+ */
+static void free_set(Set* set)
+{
+    /// Arrays shared with identical sets are freed with the last of them
+    if (set->references != NULL && --*set->references > 0){
+        set_ctor(set, 0);
+        return;
     }
-    printf("true\n");
+    free(set->references);
+    set->references = NULL;
 
-    return 1;
+    /// Elements point to string pool of universe, only array is owned by set
+    if (set->elements != NULL){
+        free(set->elements);
+        set->elements = NULL;
+    }
+    if (set->sketch != NULL){
+        free(set->sketch);
+        set->sketch = NULL;
+    }
+    free(set->ids);
+    set->ids = NULL;
+    if (set->bitset != NULL){
+        free(set->bitset);
+        set->bitset = NULL;
+    }
+    free(set->runs);
+    set->runs = NULL;
+    set->number_of_runs = 0;
+    set->elements = NULL;
+    set->cardinality = 0;
+    set->capacity = 0;
+    set->position = 0;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - relation is symmetric
- * false - in other case
+ * Constructor for list of sets
  *
- * @param[in] relation_list
- * @param[in] row_number
- * @return 0 - there isn't relation on the row, 1 - in other case
+ * @param[in] set_list
  */
-int is_symmetric(Relation_list *relation_list, int row_number)
+static void set_list_ctor(Set_list* set_list)
 {
-    if (!check_relation_existence(relation_list, &row_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
+    set_list->sets = NULL;
+    set_list->capacity = 0;
+    set_list->size = 0;
+    pool_ctor(&set_list->pool);
+    set_list->index.lists = NULL;
+    set_list->index.size = 0;
+    set_list->index.built = 0;
+}
 
-    int size = relation_list->relations[row_number].number_of_pairs;
+/// ======================================================================= ///
 
-    if (size == 0){
-        printf("true\n");
-        return 1;
+/**
+ * Function free resources for list of sets
+ *
+ * @param[in] set_list
+ */
+static void free_set_list(Set_list* set_list)
+{
+    for (int i = 0; i < set_list->size; ++i) {
+        free_set(&set_list->sets[i]);
+    }
+    if (set_list->sets != NULL) {
+        free(set_list->sets);
+        set_list->sets = NULL;
     }
+    free_pool(&set_list->pool);
+    free_inverted_index(&set_list->index);
+    set_list->size = 0;
+    set_list->capacity = 0;
+}
 
-    Pair *pairs = relation_list->relations[row_number].pairs;
+/// ======================================================================= ///
 
-    for (int i = 0; i < size; i++){
-        Pair reverse_pair;
-        reverse_pair.first = pairs[i].second;
-        reverse_pair.second = pairs[i].first;
+/**
+ * Constructor for relation
+ *
+ * @param[in] relation
+ */
+static void relation_ctor(Relation *relation, int current_row)
+{
+    relation->first = NULL;
+    relation->second = NULL;
+    relation->number_of_pairs = 0;
+    relation->deleted = 0;
+    relation->capacity = 0;
+    relation->position = current_row;
+    relation->row_offsets = NULL;
+    relation->columns = NULL;
+    relation->slots = NULL;
+    relation->column_offsets = NULL;
+    relation->rows = NULL;
+    relation->pending = NULL;
+    relation->number_of_pending = 0;
+    relation->pending_capacity = 0;
+    relation->hash = 0;
+    relation->references = NULL;
+}
 
-        if (!find_pair(pairs, reverse_pair, size)){
-            printf("false\n");
-            return 1;
-        }
+/// ======================================================================= ///
+
+/**
+ * Function free resources for relation
+ *
+ * @param[in] relation
+ */
+static void free_relation(Relation *relation)
+{
+    /// Arrays shared with identical relations are freed with the last of them
+    if (relation->references != NULL && --*relation->references > 0){
+        relation_ctor(relation, 0);
+        return;
     }
+    free(relation->references);
+    relation->references = NULL;
+
+    free(relation->first);
+    free(relation->second);
+    relation->first = NULL;
+    relation->second = NULL;
+
+    free(relation->row_offsets);
+    free(relation->columns);
+    free(relation->slots);
+    free(relation->column_offsets);
+    free(relation->rows);
+    free(relation->pending);
+    relation->row_offsets = NULL;
+    relation->columns = NULL;
+    relation->slots = NULL;
+    relation->column_offsets = NULL;
+    relation->rows = NULL;
+    relation->pending = NULL;
+    relation->number_of_pending = 0;
+    relation->pending_capacity = 0;
+
+    relation->number_of_pairs = 0;
+    relation->deleted = 0;
+    relation->capacity = 0;
+    relation->position = 0;
+}
 
-    printf("true\n");
+/// ======================================================================= ///
 
-    return 1;
+/**
+ * Constructor for list of pairs
+ *
+ * @param[in] relation_list
+ */
+static void relation_list_ctor(Relation_list *relation_list)
+{
+    relation_list->relations = NULL;
+    relation_list->size = 0;
+    relation_list->capacity = 0;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - relation is antisymmetric
- * false - in other case
+ * Function free resources for relation_list
  *
  * @param[in] relation_list
- * @param[in] row_number
- * @return 0 - there isn't relation on the row, 1 - in other case
  */
-int is_antisymmetric(Relation_list *relation_list, int row_number)
+static void free_relation_list(Relation_list *relation_list)
 {
-    if (!check_relation_existence(relation_list, &row_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    for (int i = 0; i < relation_list->size; i++){
+        free_relation(&relation_list->relations[i]);
     }
 
-    int size = relation_list->relations[row_number].number_of_pairs;
-
-    if (size == 0){
-        printf("true\n");
-        return 1;
+    if (relation_list->relations != NULL){
+        free(relation_list->relations);
+        relation_list->relations = NULL;
     }
 
-    Pair *pairs = relation_list->relations[row_number].pairs;
+    relation_list->size = 0;
+    relation_list->capacity = 0;
+}
 
-    for (int i = 0; i < size; i++){
-        Pair reverse_pair;
-        reverse_pair.first = pairs[i].second;
-        reverse_pair.second = pairs[i].first;
+/// ======================================================================= ///
 
-        /// Find symmetric relation, if pair elems aren't reflexive
-        if (strcmp(reverse_pair.first, reverse_pair.second) != 0){
-            if (find_pair(pairs, reverse_pair, size)){
-                printf("false\n");
-                return 1;
+/**
+ * Function to add element to set, element isn't copied
+ *
+ * @param[in] set
+ * @param[in] elem element stored in string pool
+ * @return 0 error, 1 in other case
+ */
+static int add_element_to_set(Set *set, char* elem)
+{
+    if (set->cardinality == set->capacity){
+        int capacity = set->capacity ? set->capacity * 2 : 10;
+
+        /// Sorted array of indexes grows with elements
+        if (set->ids != NULL){
+            int *ids = (int *) realloc(set->ids, sizeof(int) * capacity);
+            if (ids == NULL){
+                fprintf(error_output(), "Not enough memory!\n");
+                return 0;
             }
+            set->ids = ids;
         }
+
+        char** temp = (char**) realloc(set->elements, sizeof(char*) * capacity);
+        if (temp == NULL) {
+            fprintf(error_output(), "Not enough memory!\n");
+            return 0;
+        }
+        set->elements = temp;
+        set->capacity = capacity;
     }
-    printf("true\n");
+
+    set->elements[set->cardinality] = elem;
+    set->cardinality++;
 
     return 1;
 }
@@ -780,320 +1161,205 @@ int is_antisymmetric(Relation_list *relation_list, int row_number)
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - relation is injective
- * false - in other case
+ * Function copies array, NULL is copied as NULL. Copy has one spare byte,
+ * so empty array isn't mistaken for lack of memory.
  *
- * @param[in] relation_list
- * @param[in] set_list
- * @param[in] relation_number
- * @param[in] set_number_1
- * @param[in] set_number_2
- * @return 0 - error, 1 - given arg numbers are valid
+ * @param[in] source
+ * @param[in] size - number of bytes
+ * @param[out] copy
+ * @return 0 - not enough memory, 1 - in other case
  */
-int is_injective(Relation_list *relation_list, Set_list *set_list, int relation_number, int set_number_1, int set_number_2)
+static int copy_array(const void *source, size_t size, void **copy)
 {
-    if (!check_relation_existence(relation_list, &relation_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
-
-    if (!check_set_existence(set_list, &set_number_1) ||
-        !check_set_existence(set_list, &set_number_2)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
-
-    int size_of_relation = relation_list->relations[relation_number].number_of_pairs;
-    int size_of_set_1 = set_list->sets[set_number_1].cardinality;
-    int size_of_set_2 = set_list->sets[set_number_2].cardinality;
-    char** first_set = set_list->sets[set_number_1].elements;
-    char** second_set = set_list->sets[set_number_2].elements;
-
-    if (size_of_relation != size_of_set_1){
-        printf("false\n");
+    *copy = NULL;
+    if (source == NULL){
         return 1;
     }
 
-    if (size_of_set_2 < size_of_set_1){
-        printf("false\n");
-        return 1;
+    *copy = malloc(size + 1);
+    if (*copy == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
     }
+    memcpy(*copy, source, size);
 
-    Pair *pairs = relation_list->relations[relation_number].pairs;
-    char *domain_of_relation[size_of_relation];
-    char *codomain_of_relation[size_of_relation];
+    return 1;
+}
 
-    for (int i = 0; i < size_of_relation; i++){
-        domain_of_relation[i] = pairs[i].first;
-        codomain_of_relation[i] = pairs[i].second;
-    }
+/// ======================================================================= ///
 
-    qsort(domain_of_relation, size_of_relation, sizeof(char*), str_comparator);
-    qsort(codomain_of_relation, size_of_relation, sizeof(char*), str_comparator);
+/**
+ * Function shares arrays of set with identical set defined earlier.
+ * Sets are compared by hash and cardinality first, elements of identical
+ * sets point to the same names of universe. If counter of references
+ * can't be allocated, set just isn't shared.
+ *
+ * @param[in] set_list
+ * @param[in] set_number - index of set in list
+ */
+static void share_set(Set_list *set_list, int set_number)
+{
+    Set *set = &set_list->sets[set_number];
 
-    int found = 0;
-    for (int i = 0; i < size_of_relation; ++i) {
-        if (strcmp(first_set[i], domain_of_relation[i]) != 0){
-            printf("false\n");
-            return 1;
+    /// Universe keeps its own arrays
+    for (int i = 1; i < set_number; i++){
+        Set *canonical = &set_list->sets[i];
+        if (canonical->hash != set->hash || canonical->cardinality != set->cardinality ||
+            (set->cardinality > 0 && memcmp(canonical->elements, set->elements, sizeof(char *) * set->cardinality) != 0)){
+            continue;
         }
 
-        /// Check if codomain elems are in second set
-        for (int j = 0; j < size_of_set_2 && !found; ++j){
-            if (strcmp(second_set[j], codomain_of_relation[i]) == 0){
-                found = 1;
+        if (canonical->references == NULL){
+            canonical->references = (int *) malloc(sizeof(int));
+            if (canonical->references == NULL){
+                return;
             }
-        }
-        if (!found){
-            printf("false\n");
-            return 1;
+            *canonical->references = 1;
         }
 
-        /// Check if relation's domain and codomain have unique elements
-        if (((i < size_of_relation - 1) && (strcmp(domain_of_relation[i], domain_of_relation[i + 1]) == 0)) ||
-            ((i < size_of_relation - 1) && (strcmp(codomain_of_relation[i], codomain_of_relation[i + 1]) == 0))){
-            printf("false\n");
-            return 1;
-        }
+        int position = set->position;
+        free_set(set);
+        *set = *canonical;
+        set->position = position;
+        (*set->references)++;
+        return;
     }
-
-    printf("true\n");
-    return 1;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - relation is surjective
- * false - in other case
+ * Function gives shared set its own copy of arrays before it is changed
  *
- * @param[in] relation_list
  * @param[in] set_list
- * @param[in] relation_number
- * @param[in] set_number_1
- * @param[in] set_number_2
- * @return 0 - error, 1 - given arg numbers are valid
+ * @param[in] set
+ * @return 0 - not enough memory, 1 - in other case
  */
-
-int is_surjective(Relation_list *relation_list, Set_list *set_list, int relation_number, int set_number_1, int set_number_2)
+static int detach_set(Set_list *set_list, Set *set)
 {
-    if (!check_relation_existence(relation_list, &relation_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
-
-    if (!check_set_existence(set_list, &set_number_1) ||
-        !check_set_existence(set_list, &set_number_2)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
-
-    int size_of_relation = relation_list->relations[relation_number].number_of_pairs;
-    int size_of_set_1 = set_list->sets[set_number_1].cardinality;
-    int size_of_set_2 = set_list->sets[set_number_2].cardinality;
-    char** second_set = set_list->sets[set_number_2].elements;
-
-    if (size_of_relation != size_of_set_1){
-        printf("false\n");
+    if (set->references == NULL){
         return 1;
     }
-
-    if (size_of_set_2 > size_of_set_1){
-        printf("false\n");
+    if (*set->references == 1){
+        free(set->references);
+        set->references = NULL;
         return 1;
     }
 
-    Pair *pairs = relation_list->relations[relation_number].pairs;
-    char *domain_of_relation[size_of_relation];
-    char *codomain_of_relation[size_of_relation];
-
-    for (int i = 0; i < size_of_relation; i++){
-        domain_of_relation[i] = pairs[i].first;
-        codomain_of_relation[i] = pairs[i].second;
-    }
-
-    qsort(domain_of_relation, size_of_relation, sizeof(char*), str_comparator);
-    qsort(codomain_of_relation, size_of_relation, sizeof(char*), str_comparator);
-
-    int found = 0;
-    for (int i = 0; i < size_of_relation; ++i){
-
-        /// Check if codomain elems are in second set
-        for (int j = 0; j < size_of_set_2 && !found; ++j) {
-            if (strcmp(second_set[j], codomain_of_relation[i]) == 0) {
-                found = 1;
-            }
-        }
-
-        if (!found) {
-            printf("false\n");
-            return 1;
-        }
-
-        /// Check if relation domain has unique elements
-        if ((i < size_of_relation - 1) && (strcmp(domain_of_relation[i], domain_of_relation[i + 1]) == 0)){
-            printf("false\n");
-            return 1;
-        }
-    }
-
-    int j = 0;
-    /// Check if codomain contains all elements from set B (second set)
-    for (int i = 0; i < size_of_relation; ++i) {
-        while ((i < size_of_relation - 1) && (strcmp(codomain_of_relation[i], codomain_of_relation[i + 1]) == 0)) {
-            i++;
-        }
-        if ((j < size_of_set_2 - 1) && strcmp(codomain_of_relation[i], second_set[j]) != 0){
-            printf("false\n");
-            return 1;
+    int words = (set_list->sets[0].cardinality + 63) / 64;
+    void *copies[5] = {NULL, NULL, NULL, NULL, NULL};
+    int copied = copy_array(set->elements, sizeof(char *) * set->capacity, &copies[0]) &&
+                 copy_array(set->sketch, HLL_REGISTERS, &copies[1]) &&
+                 copy_array(set->ids, sizeof(int) * set->capacity, &copies[2]) &&
+                 copy_array(set->bitset, sizeof(unsigned long long) * (words + 1), &copies[3]) &&
+                 copy_array(set->runs, sizeof(int) * 2 * set->number_of_runs, &copies[4]);
+    if (!copied){
+        for (int i = 0; i < 5; i++){
+            free(copies[i]);
         }
-        j++;
+        return 0;
     }
 
-    if ( j <= size_of_set_2 - 1){
-        printf("false\n");
-        return 1;
-    }
+    (*set->references)--;
+    set->references = NULL;
+    set->elements = (char **) copies[0];
+    set->sketch = (unsigned char *) copies[1];
+    set->ids = (int *) copies[2];
+    set->bitset = (unsigned long long *) copies[3];
+    set->runs = (int *) copies[4];
 
-    printf("true\n");
     return 1;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - relation is bijective
- * false - in other case
+ * Function shares arrays of relation with identical relation defined earlier.
+ * Relations are identical if they have the same pairs in the same order,
+ * so they are printed in the same way. If counter of references can't be
+ * allocated, relation just isn't shared.
  *
  * @param[in] relation_list
- * @param[in] set_list
- * @param[in] relation_number
- * @param[in] set_number_1
- * @param[in] set_number_2
- * @return 0 - error, 1 - given arg numbers are valid
+ * @param[in] relation_number - index of relation in list
  */
-int is_bijective(Relation_list *relation_list, Set_list *set_list, int relation_number, int set_number_1, int set_number_2)
+static void share_relation(Relation_list *relation_list, int relation_number)
 {
-    if (!check_relation_existence(relation_list, &relation_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
-
-    if (!check_set_existence(set_list, &set_number_1) ||
-        !check_set_existence(set_list, &set_number_2)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
-
-    int size_of_relation = relation_list->relations[relation_number].number_of_pairs;
-    int size_of_set_1 = set_list->sets[set_number_1].cardinality;
-    int size_of_set_2 = set_list->sets[set_number_2].cardinality;
-    char** first_set = set_list->sets[set_number_1].elements;
-    char** second_set = set_list->sets[set_number_2].elements;
-
-    if (size_of_set_1 != size_of_set_2){
-        printf("false\n");
-        return 1;
-    }
-    if (size_of_relation != size_of_set_1){
-        printf("false\n");
-        return 1;
-    }
-
-    if (!size_of_relation && !size_of_set_1 && !size_of_set_2){
-        printf("true\n");
-        return 1;
-    }
-
-    Pair *pairs = relation_list->relations[relation_number].pairs;
-    char *domain_of_relation[size_of_relation];
-    char *codomain_of_relation[size_of_relation];
-
-    for (int i = 0; i < size_of_relation; i++){
-        domain_of_relation[i] = pairs[i].first;
-        codomain_of_relation[i] = pairs[i].second;
-    }
-
-    qsort(domain_of_relation, size_of_relation, sizeof(char*), str_comparator);
-    qsort(codomain_of_relation, size_of_relation, sizeof(char*), str_comparator);
-
-    int found = 0;
-    for (int i = 0; i < size_of_relation; i++){
-
-        if (strcmp(first_set[i], domain_of_relation[i]) != 0){
-            printf("false\n");
-            return 1;
+    Relation *relation = &relation_list->relations[relation_number];
+
+    for (int i = 0; i < relation_number; i++){
+        Relation *canonical = &relation_list->relations[i];
+        if (canonical->hash != relation->hash || canonical->number_of_pairs != relation->number_of_pairs ||
+            (relation->number_of_pairs > 0 &&
+             (memcmp(canonical->first, relation->first, sizeof(int) * relation->number_of_pairs) != 0 ||
+              memcmp(canonical->second, relation->second, sizeof(int) * relation->number_of_pairs) != 0))){
+            continue;
         }
 
-        /// Check if codomain elems are in second set
-        for (int j = 0; j < size_of_set_2 && !found; ++j){
-            if (strcmp(second_set[j], codomain_of_relation[i]) == 0){
-                found = 1;
+        if (canonical->references == NULL){
+            canonical->references = (int *) malloc(sizeof(int));
+            if (canonical->references == NULL){
+                return;
             }
-        }
-        if (!found){
-            printf("false\n");
-            return 1;
+            *canonical->references = 1;
         }
 
-        /// Check if relation's domain and codomain have unique elements
-        if (((i < size_of_relation - 1) && (strcmp(domain_of_relation[i], domain_of_relation[i + 1]) == 0)) ||
-            ((i < size_of_relation - 1) && (strcmp(codomain_of_relation[i], codomain_of_relation[i + 1]) == 0))){
-            printf("false\n");
-            return 1;
-        }
+        int position = relation->position;
+        free_relation(relation);
+        *relation = *canonical;
+        relation->position = position;
+        (*relation->references)++;
+        return;
     }
-
-    printf("true\n");
-    return 1;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - relation is transitive
- * false - in other case
+ * Function gives shared relation its own copy of arrays before it is changed
  *
- * @param[in] relation_list
- * @param[in] row_number
- * @return 0 - there isn't relation on the row, 1 - in other case
+ * @param[in] relation
+ * @param[in] set_list
+ * @return 0 - not enough memory, 1 - in other case
  */
-int is_transitive(Relation_list *relation_list, int row_number)
+static int detach_relation(Relation *relation, Set_list *set_list)
 {
-    if (!check_relation_existence(relation_list, &row_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    if (relation->references == NULL){
+        return 1;
     }
-
-    int size_of_relation = relation_list->relations[row_number].number_of_pairs;
-
-    if (size_of_relation == 0){
-        printf("true\n");
+    if (*relation->references == 1){
+        free(relation->references);
+        relation->references = NULL;
         return 1;
     }
 
-    Pair *pairs = relation_list->relations[row_number].pairs;
-
-    for (int i = 0; i < size_of_relation; i++){
-        for (int j = 0; j < size_of_relation; j++){
-            if (strcmp(pairs[i].second, pairs[j].first) == 0){
-                Pair pair;
-                pair.first = pairs[i].first;
-                pair.second = pairs[j].second;
-
-                if (!(find_pair(pairs, pair, size_of_relation))){
-                    printf("false\n");
-                    return 1;
-                }
-            }
+    size_t offsets_size = sizeof(int) * (set_list->sets[0].cardinality + 1);
+    size_t pairs_size = sizeof(int) * relation->capacity;
+    void *copies[8] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+    int copied = copy_array(relation->first, pairs_size, &copies[0]) &&
+                 copy_array(relation->second, pairs_size, &copies[1]) &&
+                 copy_array(relation->row_offsets, offsets_size, &copies[2]) &&
+                 copy_array(relation->columns, pairs_size + sizeof(int), &copies[3]) &&
+                 copy_array(relation->column_offsets, offsets_size, &copies[4]) &&
+                 copy_array(relation->rows, pairs_size + sizeof(int), &copies[5]) &&
+                 copy_array(relation->slots, pairs_size + sizeof(int), &copies[6]) &&
+                 copy_array(relation->pending, sizeof(Pending_pair) * relation->pending_capacity, &copies[7]);
+    if (!copied){
+        for (int i = 0; i < 8; i++){
+            free(copies[i]);
         }
+        return 0;
     }
 
-    printf("true\n");
+    (*relation->references)--;
+    relation->references = NULL;
+    relation->first = (int *) copies[0];
+    relation->second = (int *) copies[1];
+    relation->row_offsets = (int *) copies[2];
+    relation->columns = (int *) copies[3];
+    relation->column_offsets = (int *) copies[4];
+    relation->rows = (int *) copies[5];
+    relation->slots = (int *) copies[6];
+    relation->pending = (Pending_pair *) copies[7];
 
     return 1;
 }
@@ -1101,60 +1367,72 @@ int is_transitive(Relation_list *relation_list, int row_number)
 /// ======================================================================= ///
 
 /**
- * Function prints complement of set
+ * Function add set to list, set identical to set defined earlier shares its arrays
  *
- * @param[in] set_number
  * @param[in] set_list
- * @return 0 - error, 1 - given set number is valid
+ * @param[in] new_set set, that will be added to list
  */
-int set_complement(Set_list* set_list, int set_number)
+static int add_set_to_list(Set_list* set_list, Set* new_set)
 {
-    if (!check_set_existence(set_list, &set_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    if (set_list->sets == NULL){
+        set_list->size = 1;
+        set_list->capacity = 10;
+        set_list->sets = (Set*) malloc(sizeof(Set) * set_list->capacity);
     }
-
-    /// Universe
-    char** universe_elems = set_list->sets[0].elements;
-    int universe_size = set_list->sets[0].cardinality;
-
-    /// Given set on line set_number
-    char** given_set_elems = set_list->sets[set_number].elements;
-    int set_size = set_list->sets[set_number].cardinality;
-
-    int set_idx = 0;
-
-    printf("S");
-    for (int i = 0; i < universe_size; ++i) {
-        if ( set_idx < set_size && strcmp(universe_elems[i], given_set_elems[set_idx]) == 0){
-            set_idx++;
-        }
-        else {
-            printf(" %s", universe_elems[i]);
+    else {
+        Set* temp = NULL;
+        set_list->size++;
+        if ( set_list->size > set_list->capacity ){
+            set_list->capacity *=2;
+            temp = (Set*) realloc(set_list->sets, sizeof(Set) * set_list->capacity);
+            if (temp == NULL){
+                free_set_list(set_list);
+                fprintf(stderr, "Not enough memory!\n");
+                return 0;
+            }
+            set_list->sets = temp;
         }
     }
-    printf("\n");
-
+    set_list->sets[set_list->size - 1] = *new_set;
+    share_set(set_list, set_list->size - 1);
     return 1;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function print number of elements in set
+ * Function add pair of indexes of elements in universe to relation,
+ * first and second elements are stored in separate arrays
  *
- * @param set_list
- * @param set_number
- * @return 0 - error, 1 - given set number is valid
+ * @param[in] relation
+ * @param[in] first
+ * @param[in] second
+ * @return 0 - not enough memory, 1 - in other case
  */
-int set_card(Set_list *set_list, int set_number)
+static int add_pair_to_relation(Relation *relation, int first, int second)
 {
-    if (!check_set_existence(set_list, &set_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    /// New pair is stored after deleted pairs, which are removed when adjacency is built again
+    int slot = relation->number_of_pairs + relation->deleted;
+    if (relation->capacity == slot){
+        int capacity = relation->capacity ? relation->capacity * 2 : 16;
+        int *firsts = (int *) realloc(relation->first, sizeof(int) * capacity);
+        if (firsts != NULL){
+            relation->first = firsts;
+        }
+        int *seconds = (int *) realloc(relation->second, sizeof(int) * capacity);
+        if (seconds != NULL){
+            relation->second = seconds;
+        }
+        if (firsts == NULL || seconds == NULL){
+            fprintf(error_output(), "Not enough memory!\n");
+            return 0;
+        }
+        relation->capacity = capacity;
     }
 
-    printf("%d\n", set_list->sets[set_number].cardinality);
+    relation->first[slot] = first;
+    relation->second[slot] = second;
+    relation->number_of_pairs++;
 
     return 1;
 }
@@ -1162,45 +1440,37 @@ int set_card(Set_list *set_list, int set_number)
 /// ======================================================================= ///
 
 /**
- * Function print union of sets
+ * Function add relation to list of relations, relation identical to relation
+ * defined earlier shares its arrays
  *
- * @param set_list
- * @param set_number_1
- * @param set_number_2
- * @return 0 - error, 1 - given set number is valid
+ * @param[in] relation_list
+ * @param[in] relation relation, that will be added to list
  */
-int union_of_sets(Set_list *set_list, int set_number_1, int set_number_2)
+static int add_relation_to_list(Relation_list *relation_list, Relation *relation)
 {
-    if (!check_set_existence(set_list, &set_number_1) ||
-        !check_set_existence(set_list, &set_number_2)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
-
-    char** first_set = set_list->sets[set_number_1].elements;
-    int first_set_size = set_list->sets[set_number_1].cardinality;
-
-    char** second_set = set_list->sets[set_number_2].elements;
-    int second_set_size = set_list->sets[set_number_2].cardinality;
-
-
-    printf("S");
-    for (int i = 0; i < first_set_size; i++){
-        printf(" %s", first_set[i]);
-    }
-
-    for (int i = 0; i < second_set_size; i++){
-        int found = 0;
-        for (int j = 0; j < first_set_size; j++){
-            if (strcmp(second_set[i], first_set[j]) == 0){
-                found = 1;
+    if (relation_list->capacity == relation_list->size){
+        if (relation_list->relations == NULL){
+            relation_list->capacity = 10;
+            relation_list->relations = (Relation *) malloc(sizeof(Relation) * relation_list->capacity);
+            if (relation_list->relations == NULL){
+                fprintf(stderr, "Not enough memory!\n");
+                return 0;
             }
         }
-        if (!found){
-            printf(" %s", second_set[i]);
+        else {
+            relation_list->capacity += 5;
+            Relation *pointer;
+            pointer = (Relation *) realloc(relation_list->relations, sizeof(Relation) * relation_list->capacity);
+            if (pointer == NULL){
+                fprintf(stderr, "Not enough memory!\n");
+                return 0;
+            }
+            relation_list->relations = pointer;
         }
     }
-    printf("\n");
+    relation_list->size++;
+    relation_list->relations[relation_list->size - 1] = *relation;
+    share_relation(relation_list, relation_list->size - 1);
 
     return 1;
 }
@@ -1208,268 +1478,226 @@ int union_of_sets(Set_list *set_list, int set_number_1, int set_number_2)
 /// ======================================================================= ///
 
 /**
- * Function prints minus of 2 sets
+ * Function print set on stdout
  *
- * @param[in] set_list
- * @param[in] set_number_1
- * @param[in] set_number_2
- * @return 0 - error, 1 - given set number is valid
+ * @param[in] set set to print
  */
-int minus_of_sets(Set_list *set_list, int set_number_1, int set_number_2)
+static void print_set(Set_list *set_list, Set set)
 {
-
-    if (!check_set_existence(set_list, &set_number_1) ||
-        !check_set_existence(set_list, &set_number_2)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    emit_set_begin(set_list->size == 1 ? 'U' : 'S');
+    for (int i = 0; i < set.cardinality; i++){
+        emit_name(set_list, set.elements[i]);
     }
+    emit_set_end(set_list);
+}
 
-    char** first_set = set_list->sets[set_number_1].elements;
-    int first_set_size = set_list->sets[set_number_1].cardinality;
-
-    char** second_set = set_list->sets[set_number_2].elements;
-    int second_set_size = set_list->sets[set_number_2].cardinality;
-
-    int is_found = 0;
-    int curr_s2_idx = 0;
-
-    printf("S");
+/// ======================================================================= ///
 
-    for (int i = 0; i < first_set_size; ++i) {
-        for (int j = curr_s2_idx; j < second_set_size && !is_found; ++j) {
-            if (strcmp(first_set[i], second_set[j]) == 0){
-                is_found = 1;
-                curr_s2_idx = j + 1;
-            }
-        }
-        if (!is_found) {
-            printf(" %s", first_set[i]);
+/**
+ * Function print relation on stdout
+ *
+ * @param[in] set_list
+ * @param[in] relation relation to print
+ */
+static void print_relation(Set_list *set_list, Relation relation)
+{
+    emit_relation_begin();
+    for (int i = 0; i < relation.number_of_pairs + relation.deleted; i++){
+        if (relation.first[i] >= 0){
+            emit_pair(set_list, relation.first[i], relation.second[i]);
         }
-        is_found = 0;
     }
-
-    printf("\n");
-
-    return 1;
+    emit_relation_end();
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - set is subset of other set
- * false - in other case
+ * Function find index of set on given row
  *
  * @param[in] set_list
- * @param[in] set_number_1
- * @param[in] set_number_2
- * @return 0 - given set numbers are invalid, 1 - input is correct
+ * @param[in] row
+ * @return 0 - there isn't set on the row, 1 in other case
  */
-int is_subset(Set_list *set_list, int set_number_1, int set_number_2)
+static int check_set_existence(Set_list* set_list, int* row)
 {
-    if (!check_set_existence(set_list, &set_number_1) ||
-        !check_set_existence(set_list, &set_number_2)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
-
-    char** first_set = set_list->sets[set_number_1].elements;
-    int first_set_size = set_list->sets[set_number_1].cardinality;
-
-    char** second_set = set_list->sets[set_number_2].elements;
-    int second_set_size = set_list->sets[set_number_2].cardinality;
-
-    /// Subset can't be greater than superset or equal to it
-    if (first_set_size >= second_set_size){
-        printf("false\n");
-        return 1;
+    for (int i = 0; i < set_list->size; i++) {
+        if (set_list->sets[i].position == *row){
+            *row = i;
+            return 1;
+        }
     }
+    return 0;
+}
 
-    int has_elem = 0;
-    int curr_set_idx = 0;
+/// ======================================================================= ///
 
-    for (int i = 0; i < first_set_size; ++i) {
-        for (int j = curr_set_idx; j < second_set_size && !has_elem; ++j) {
-            if (strcmp(first_set[i], second_set[j]) == 0){
-                has_elem = 1;
-                curr_set_idx = j + 1;
-            }
-        }
-        if (!has_elem){
-            printf("false\n");
+/**
+ * Function find index of relation on given row
+ *
+ * @param[in] rel_list
+ * @param[in] row
+ * @return 0 - there isn't relation on the row, 1 in other case
+ */
+static int check_relation_existence(Relation_list* rel_list, int* row)
+{
+    for (int i = 0; i < rel_list->size; ++i) {
+        if (rel_list->relations[i].position == *row){
+            *row = i;
             return 1;
         }
-        has_elem = 0;
     }
-    printf("true\n");
-
-    return 1;
+    return 0;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - set is subseteq of other set
- * false - in other case
+ * Function finds pair in adjacency of relation, changes made after adjacency
+ * was built aren't taken into account
  *
- * @param[in] set_list
- * @param[in] set_number_1
- * @param[in] set_number_2
- * @return 0 - given set numbers are invalid, 1 - input is correct
+ * @param[in] relation
+ * @param[in] first - index of first element in universe
+ * @param[in] second - index of second element in universe
+ * @return position of pair in columns, -1 - pair isn't in adjacency
  */
-int is_subseteq(Set_list *set_list, int set_number_1, int set_number_2)
+static int adjacency_find(Relation *relation, int first, int second)
 {
-    if (!check_set_existence(set_list, &set_number_1) ||
-        !check_set_existence(set_list, &set_number_2)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    int low = relation->row_offsets[first];
+    int high = relation->row_offsets[first + 1];
+    while (low < high){
+        int middle = low + (high - low) / 2;
+        if (relation->columns[middle] < second){
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
     }
 
-    char** first_set = set_list->sets[set_number_1].elements;
-    int first_set_size = set_list->sets[set_number_1].cardinality;
+    if ((low < relation->row_offsets[first + 1]) && (relation->columns[low] == second)){
+        return low;
+    }
+    return -1;
+}
 
-    char** second_set = set_list->sets[set_number_2].elements;
-    int second_set_size = set_list->sets[set_number_2].cardinality;
+/// ======================================================================= ///
 
-    /// Subseteq can't be greater than superset
-    if (first_set_size > second_set_size){
-        printf("false\n");
-    }
-    else if (first_set_size == 0){
-        printf("true\n");
-    }
-    else {
-        int found;
-        int has_elem = 0;
-        for (int i = 0; i < first_set_size; i++){
-            found = 0;
-            for (int j = 0; j < second_set_size; j++){
-                if (strcmp(first_set[i], second_set[j]) == 0){
-                    found = 1;
-                    has_elem++;
-                    break;
-                }
-            }
-            if (!found){
-                printf("false\n");
-                break;
-            }
+/**
+ * Function finds position of pair in sorted pending pairs of relation
+ *
+ * @param[in] relation
+ * @param[in] key - first << 32 | second
+ * @return position of pair or position where pair belongs
+ */
+static int pending_lower_bound(Relation *relation, unsigned long long key)
+{
+    int low = 0;
+    int high = relation->number_of_pending;
+    while (low < high){
+        int middle = low + (high - low) / 2;
+        if (relation->pending[middle].key < key){
+            low = middle + 1;
         }
-
-        if (found){
-            printf("true\n");
+        else {
+            high = middle;
         }
     }
 
-    return 1;
+    return low;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function prints:
- * true - set is empty
- * false - not empty
+ * Function sets slot of pending pair, pair is inserted if it isn't pending yet
  *
- * @param[in] set_list
- * @param[in] set_number
- * @return 0 - given set number is valid, 1 - input is correct
+ * @param[in] relation
+ * @param[in] key - first << 32 | second
+ * @param[in] slot - position in first and second, -1 - pair of adjacency was deleted
+ * @return 0 - not enough memory, 1 - in other case
  */
-int is_set_empty(Set_list *set_list, int set_number)
+static int set_pending(Relation *relation, unsigned long long key, int slot)
 {
-    if (!check_set_existence(set_list, &set_number)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
+    int position = pending_lower_bound(relation, key);
+    if (position < relation->number_of_pending && relation->pending[position].key == key){
+        relation->pending[position].slot = slot;
+        return 1;
     }
 
-    if (set_list->sets[set_number].cardinality == 0){
-        printf("true\n");
-    }
-    else {
-        printf("false\n");
+    if (relation->number_of_pending == relation->pending_capacity){
+        int capacity = relation->pending_capacity ? relation->pending_capacity * 2 : 16;
+        Pending_pair *pending = (Pending_pair *) realloc(relation->pending, sizeof(Pending_pair) * capacity);
+        if (pending == NULL){
+            fprintf(stderr, "Not enough memory!\n");
+            return 0;
+        }
+        relation->pending = pending;
+        relation->pending_capacity = capacity;
     }
 
+    memmove(relation->pending + position + 1, relation->pending + position,
+            sizeof(Pending_pair) * (relation->number_of_pending - position));
+    relation->pending[position].key = key;
+    relation->pending[position].slot = slot;
+    relation->number_of_pending++;
+
     return 1;
 }
 
 /// ======================================================================= ///
 
 /**
-* Prints true - equal, false - not equal
-*
-* @param[in] set_list
-* @param[in] set_number_1
-* @param[in] set_number_2
-*/
-int are_sets_equal(Set_list *set_list, int set_number_1, int set_number_2)
+ * Function finds pair in relation
+ *
+ * @param[in] relation
+ * @param[in] first - index of first element in universe
+ * @param[in] second - index of second element in universe
+ * @return 1 - pair found, 0 - in other case
+ */
+static int relation_contains(Relation *relation, int first, int second)
 {
-    if (!check_set_existence(set_list, &set_number_1) ||
-        !check_set_existence(set_list, &set_number_2)){
-        fprintf(stderr, "Can't step on nonexistent row!\n");
-        return 0;
-    }
-
-    char** first_set = set_list->sets[set_number_1].elements;
-    int first_set_size = set_list->sets[set_number_1].cardinality;
-
-    char** second_set = set_list->sets[set_number_2].elements;
-    int second_set_size = set_list->sets[set_number_2].cardinality;
-
-    if (first_set_size != second_set_size){
-        printf("false\n");
-    }
-    else if ((first_set_size == 0) && (second_set_size == 0)){
-        printf("true\n");
-    }
-    else {
-        for (int i = 0; i < first_set_size; i++){
-            if (strcmp(first_set[i], second_set[i]) != 0){
-                printf("false\n");
-                return 1;
-            }
-            else {
-                continue;
-            }
+    /// Pairs changed after adjacency was built override it
+    if (relation->number_of_pending > 0){
+        unsigned long long key = ((unsigned long long) first << 32) | (unsigned) second;
+        int position = pending_lower_bound(relation, key);
+        if (position < relation->number_of_pending && relation->pending[position].key == key){
+            return relation->pending[position].slot >= 0;
         }
-        printf("true\n");
     }
 
-    return 1;
+    return adjacency_find(relation, first, second) >= 0;
 }
 
 /// ======================================================================= ///
 
 /**
-* Function prints intersect of 2 sets
-*
-* @param[in] set_list
-* @param[in] set_number_1
-* @param[in] set_number_2
-*/
-int intersect_of_sets(Set_list *set_list, int set_number_1, int set_number_2)
+ * Function find domain or codomain of relation, which are
+ * elements with nonempty row or column of adjacency
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] row_number
+ * @param[in] codomain_flag 0 - find domain, 1 - find codomain
+ * @return 0 - there isn't relation on the row, 1 in other case
+ */
+static int domain_or_codomain(Relation_list* relation_list, Set_list *set_list, int row_number, int codomain_flag)
 {
-    if (!check_set_existence(set_list, &set_number_1) ||
-        !check_set_existence(set_list, &set_number_2)){
+    if (!check_relation_existence(relation_list, &row_number)){
         fprintf(stderr, "Can't step on nonexistent row!\n");
         return 0;
     }
 
-    char** first_set = set_list->sets[set_number_1].elements;
-    int first_set_size = set_list->sets[set_number_1].cardinality;
-
-    char** second_set = set_list->sets[set_number_2].elements;
-    int second_set_size = set_list->sets[set_number_2].cardinality;
+    Relation *relation = &relation_list->relations[row_number];
+    int *offsets = codomain_flag ? relation->column_offsets : relation->row_offsets;
 
-    printf("S");
-    for (int i = 0; i < first_set_size; i++){
-        for (int j = 0; j < second_set_size; j++){
-            if (strcmp(first_set[i], second_set[j]) == 0){
-                printf(" %s", first_set[i]);
-            }
+    emit_set_begin('S');
+    for (int i = 0; i < set_list->sets[0].cardinality; i++){
+        if (offsets[i + 1] > offsets[i]){
+            emit_element(set_list, i);
         }
     }
-    printf("\n");
+    emit_set_end(set_list);
 
     return 1;
 }
@@ -1477,61 +1705,64 @@ int intersect_of_sets(Set_list *set_list, int set_number_1, int set_number_2)
 /// ======================================================================= ///
 
 /**
- * Function to check if element is in universe
+ * Function prints:
+ * true - relation is function
+ * false - in other case
  *
- * @param[in] element - element to check
+ * @param[in] relation_list
  * @param[in] set_list
- * @return 0 - element isn't in universe, 1 - in other case
+ * @param[in] row_number
+ * @return 0 - there isn't relation on the row, 1 - in other case
  */
-int is_element_in_universe(Set_list *set_list, char *element)
+static int is_function(Relation_list *relation_list, Set_list *set_list, int row_number)
 {
+    if (!check_relation_existence(relation_list, &row_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    /// Every element of universe has at most one pair in its row of adjacency
+    int *offsets = relation_list->relations[row_number].row_offsets;
     for (int i = 0; i < set_list->sets[0].cardinality; i++){
-        if (strcmp(element, set_list->sets[0].elements[i]) == 0){
+        if (offsets[i + 1] - offsets[i] > 1){
+            emit_bool(0);
             return 1;
         }
     }
+    emit_bool(1);
 
-    fprintf(stderr, "Error: Element %s isn't in universe\n", element);
-
-    return 0;
+    return 1;
 }
 
 /// ======================================================================= ///
 
 /**
- * Function to check syntax of element
+ * Function prints:
+ * true - relation is reflexive
+ * false - in other case
  *
- * @param[in] element - element to check
+ * @param[in] relation_list
  * @param[in] set_list
- * @return 0 - element has wrong syntax, 1 - in other case
+ * @param[in] row_number
+ * @return 0 - there isn't relation on the row, 1 - in other case
  */
-int check_element_syntax(Set_list *set_list, char *element)
+static int is_reflexive(Relation_list *relation_list, Set_list *set_list, int row_number)
 {
-    char *command[] = {"empty", "card", "complement", "union",
-                       "intersect", "minus", "subseteq", "subset", "equals",
-                       "reflexive", "symmetric", "antisymmetric", "transitive",
-                       "function", "domain", "codomain", "injective",
-                       "surjective", "bijective", "true", "false"};
-
-    for (int i = 0; element[i] != '\0'; i++){
-        if (!(isalpha(element[i]))){
-            fprintf(stderr, "Wrong element syntax!\n");
-            return 0;
-        }
+    if (!check_relation_existence(relation_list, &row_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
     }
 
-    for (int i = 0; i < 21; i++){
-        if (strcmp(element, command[i]) == 0){
-            fprintf(stderr, "Set contains identifier of command!\n");
-            return 0;
-        }
-    }
+    Relation *relation = &relation_list->relations[row_number];
+    int size_of_universe = set_list->sets[0].cardinality;
 
-    if (set_list->size > 0){
-        if (!is_element_in_universe(set_list, element)){
-            return 0;
+    for (int i = 0; i < size_of_universe; i++){
+        if (!relation_contains(relation, i, i)){
+            emit_bool(0);
+            return 1;
         }
     }
+    emit_bool(1);
 
     return 1;
 }
@@ -1539,635 +1770,5777 @@ int check_element_syntax(Set_list *set_list, char *element)
 /// ======================================================================= ///
 
 /**
- * Function parses options given in file
+ * Function prints:
+ * true - relation is symmetric
+ * false - in other case
  *
- * @param file
- * @param set_list
- * @return 0 - command was wrong, 1 - in other case
+ * @param[in] relation_list
+ * @param[in] row_number
+ * @return 0 - there isn't relation on the row, 1 - in other case
  */
-int read_command(FILE *file, Set_list *set_list, Relation_list *relation_list)
+static int is_symmetric(Relation_list *relation_list, int row_number)
 {
-    char *command[] = {"empty", "card", "complement", "union",
-                       "intersect", "minus", "subseteq", "subset", "equals",
-                       "reflexive", "symmetric", "antisymmetric", "transitive",
-                       "function", "domain", "codomain", "injective",
-                       "surjective", "bijective"};
-
-
-    char c = fgetc(file);
-    if (c != ' '){
-        fprintf(stderr, "Wrong syntax of input file!\n");
+    if (!check_relation_existence(relation_list, &row_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
         return 0;
     }
 
-    /// Skip all spaced before command
-    while (isblank(c)){
-        c = fgetc(file);
-    }
+    Relation *relation = &relation_list->relations[row_number];
 
-    char loaded_command[15];
-    int index = 1;
+    for (int i = 0; i < relation->number_of_pairs; i++){
+        if (!relation_contains(relation, relation->second[i], relation->first[i])){
+            emit_bool(0);
+            return 1;
+        }
+    }
 
-    loaded_command[0] = c;
+    emit_bool(1);
 
-    while (((c = fgetc(file)) != ' ') && (c != '\n')){
-        if (index > 14){
-            fprintf(stderr, "Command %s doesn't exist\n", loaded_command);
-            return 0;
-        }
-        if (!isblank(c)){
-            loaded_command[index] = (char)c;
-            index++;
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints:
+ * true - relation is antisymmetric
+ * false - in other case
+ *
+ * @param[in] relation_list
+ * @param[in] row_number
+ * @return 0 - there isn't relation on the row, 1 - in other case
+ */
+static int is_antisymmetric(Relation_list *relation_list, int row_number)
+{
+    if (!check_relation_existence(relation_list, &row_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Relation *relation = &relation_list->relations[row_number];
+
+    for (int i = 0; i < relation->number_of_pairs; i++){
+        /// Find symmetric relation, if pair elems aren't reflexive
+        if ((relation->first[i] != relation->second[i]) &&
+            relation_contains(relation, relation->second[i], relation->first[i])){
+            emit_bool(0);
+            return 1;
         }
     }
-    loaded_command[index] = '\0';
+    emit_bool(1);
 
-    int arg_1 = 0;
-    int arg_2 = 0;
-    int arg_3 = 0;
-    fscanf(file, "%d", &arg_1);
-    if (!arg_1){
-        fprintf(stderr, "Too few arguments!\n");
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function finds element of universe on position of sorted first (or second)
+ * elements of pairs. Offsets of adjacency are walked, so pairs aren't copied
+ * and sorted.
+ *
+ * @param[in] offsets - row_offsets or column_offsets of relation
+ * @param[in,out] element - element on the previous position, 0 before the first one
+ * @param[in] position - positions have to be ascending
+ */
+static void sorted_element(int *offsets, int *element, int position)
+{
+    while (offsets[*element + 1] <= position){
+        (*element)++;
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints:
+ * true - relation is injective
+ * false - in other case
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number
+ * @param[in] set_number_1
+ * @param[in] set_number_2
+ * @return 0 - error, 1 - given arg numbers are valid
+ */
+static int is_injective(Relation_list *relation_list, Set_list *set_list, int relation_number, int set_number_1, int set_number_2)
+{
+    if (!check_relation_existence(relation_list, &relation_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
         return 0;
     }
-    fscanf(file, "%d", &arg_2);
-    fscanf(file, "%d", &arg_3);
-    if (arg_3){
-        while (isblank(c)){
-            c = fgetc(file);
-        }
 
-        if ((c != '\n') && (c != EOF)){
-            fprintf(stderr, "Too many arguments!\n");
-            return 0;
-        }
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
     }
 
-    int i;
-    for (i = 0; i < 19; i++){
-        if (strcmp(loaded_command, command[i]) == 0){
-            break;
-        }
+    int size_of_relation = relation_list->relations[relation_number].number_of_pairs;
+    int size_of_set_1 = set_list->sets[set_number_1].cardinality;
+    int size_of_set_2 = set_list->sets[set_number_2].cardinality;
+    char** first_set = set_list->sets[set_number_1].elements;
+    char** second_set = set_list->sets[set_number_2].elements;
+
+    if (size_of_relation != size_of_set_1){
+        emit_bool(0);
+        return 1;
     }
-    switch (i){
-        case EMPTY:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!is_set_empty(set_list, arg_1)){
-                return 0;
-            }
-            break;
+
+    if (size_of_set_2 < size_of_set_1){
+        emit_bool(0);
+        return 1;
+    }
+
+    Relation *relation = &relation_list->relations[relation_number];
+    char **universe = set_list->sets[0].elements;
+    int *row_offsets = relation->row_offsets;
+    int *column_offsets = relation->column_offsets;
+    int domain = 0;
+    int codomain = 0;
+
+    int found = 0;
+    for (int i = 0; i < size_of_relation; ++i) {
+        sorted_element(row_offsets, &domain, i);
+        sorted_element(column_offsets, &codomain, i);
+
+        if (strcmp(first_set[i], universe[domain]) != 0){
+            emit_bool(0);
+            return 1;
         }
-        case CARD:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!set_card(set_list, arg_1)){
-                return 0;
+
+        /// Check if codomain elems are in second set
+        for (int j = 0; j < size_of_set_2 && !found; ++j){
+            if (strcmp(second_set[j], universe[codomain]) == 0){
+                found = 1;
             }
-            break;
         }
-        case COMPLEMENT:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!set_complement(set_list, arg_1)){
-                return 0;
-            }
-            break;
+        if (!found){
+            emit_bool(0);
+            return 1;
         }
-        case UNION:{
-            if (!arg_2){
-                fprintf(stderr, "Too few arguments!\n");
-                return 0;
-            }
-            if (arg_3){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!union_of_sets(set_list, arg_1, arg_2)){
-                return 0;
-            }
-            break;
+
+        /// Check if relation's domain and codomain have unique elements
+        if ((row_offsets[domain + 1] > i + 1) ||
+            (column_offsets[codomain + 1] > i + 1)){
+            emit_bool(0);
+            return 1;
         }
-        case INTERSECT:{
-            if (!arg_2){
-                fprintf(stderr, "Too few arguments!\n");
-                return 0;
-            }
-            if (arg_3){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!intersect_of_sets(set_list, arg_1, arg_2)){
-                return 0;
+    }
+
+    emit_bool(1);
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints:
+ * true - relation is surjective
+ * false - in other case
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number
+ * @param[in] set_number_1
+ * @param[in] set_number_2
+ * @return 0 - error, 1 - given arg numbers are valid
+ */
+
+static int is_surjective(Relation_list *relation_list, Set_list *set_list, int relation_number, int set_number_1, int set_number_2)
+{
+    if (!check_relation_existence(relation_list, &relation_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    int size_of_relation = relation_list->relations[relation_number].number_of_pairs;
+    int size_of_set_1 = set_list->sets[set_number_1].cardinality;
+    int size_of_set_2 = set_list->sets[set_number_2].cardinality;
+    char** second_set = set_list->sets[set_number_2].elements;
+
+    if (size_of_relation != size_of_set_1){
+        emit_bool(0);
+        return 1;
+    }
+
+    if (size_of_set_2 > size_of_set_1){
+        emit_bool(0);
+        return 1;
+    }
+
+    Relation *relation = &relation_list->relations[relation_number];
+    char **universe = set_list->sets[0].elements;
+    int *row_offsets = relation->row_offsets;
+    int *column_offsets = relation->column_offsets;
+    int domain = 0;
+    int codomain = 0;
+
+    int found = 0;
+    for (int i = 0; i < size_of_relation; ++i){
+        sorted_element(row_offsets, &domain, i);
+        sorted_element(column_offsets, &codomain, i);
+
+        /// Check if codomain elems are in second set
+        for (int j = 0; j < size_of_set_2 && !found; ++j) {
+            if (strcmp(second_set[j], universe[codomain]) == 0) {
+                found = 1;
             }
-            break;
         }
-        case MINUS:{
-            if (!arg_2){
-                fprintf(stderr, "Too few arguments!\n");
-                return 0;
-            }
-            if (arg_3){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!minus_of_sets(set_list, arg_1, arg_2)){
-                return 0;
-            }
-            break;
+
+        if (!found) {
+            emit_bool(0);
+            return 1;
         }
-        case SUBSETEQ:{
-            if (!arg_2){
-                fprintf(stderr, "Too few arguments!\n");
-                return 0;
-            }
-            if (arg_3){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!is_subseteq(set_list, arg_1, arg_2)){
-                return 0;
-            }
-            break;
+
+        /// Check if relation domain has unique elements
+        if (row_offsets[domain + 1] > i + 1){
+            emit_bool(0);
+            return 1;
         }
-        case SUBSET:{
-            if (!arg_2){
-                fprintf(stderr, "Too few arguments!\n");
-                return 0;
-            }
-            if (arg_3){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!is_subset(set_list, arg_1, arg_2)){
-                return 0;
-            }
-            break;
+    }
+
+    int j = 0;
+    codomain = 0;
+    /// Check if codomain contains all elements from set B (second set)
+    for (int i = 0; i < size_of_relation; ++i) {
+        sorted_element(column_offsets, &codomain, i);
+        i = column_offsets[codomain + 1] - 1;
+        if ((j < size_of_set_2 - 1) && strcmp(universe[codomain], second_set[j]) != 0){
+            emit_bool(0);
+            return 1;
         }
-        case EQUALS:{
-            if (!arg_2){
-                fprintf(stderr, "Too few arguments!\n");
-                return 0;
-            }
-            if (arg_3){
-                fprintf(stderr, "Too many arguments!\n");
+        j++;
+    }
+
+    if ( j <= size_of_set_2 - 1){
+        emit_bool(0);
+        return 1;
+    }
+
+    emit_bool(1);
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints:
+ * true - relation is bijective
+ * false - in other case
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number
+ * @param[in] set_number_1
+ * @param[in] set_number_2
+ * @return 0 - error, 1 - given arg numbers are valid
+ */
+static int is_bijective(Relation_list *relation_list, Set_list *set_list, int relation_number, int set_number_1, int set_number_2)
+{
+    if (!check_relation_existence(relation_list, &relation_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    int size_of_relation = relation_list->relations[relation_number].number_of_pairs;
+    int size_of_set_1 = set_list->sets[set_number_1].cardinality;
+    int size_of_set_2 = set_list->sets[set_number_2].cardinality;
+    char** first_set = set_list->sets[set_number_1].elements;
+    char** second_set = set_list->sets[set_number_2].elements;
+
+    if (size_of_set_1 != size_of_set_2){
+        emit_bool(0);
+        return 1;
+    }
+    if (size_of_relation != size_of_set_1){
+        emit_bool(0);
+        return 1;
+    }
+
+    if (!size_of_relation && !size_of_set_1 && !size_of_set_2){
+        emit_bool(1);
+        return 1;
+    }
+
+    Relation *relation = &relation_list->relations[relation_number];
+    char **universe = set_list->sets[0].elements;
+    int *row_offsets = relation->row_offsets;
+    int *column_offsets = relation->column_offsets;
+    int domain = 0;
+    int codomain = 0;
+
+    int found = 0;
+    for (int i = 0; i < size_of_relation; i++){
+        sorted_element(row_offsets, &domain, i);
+        sorted_element(column_offsets, &codomain, i);
+
+        if (strcmp(first_set[i], universe[domain]) != 0){
+            emit_bool(0);
+            return 1;
+        }
+
+        /// Check if codomain elems are in second set
+        for (int j = 0; j < size_of_set_2 && !found; ++j){
+            if (strcmp(second_set[j], universe[codomain]) == 0){
+                found = 1;
+            }
+        }
+        if (!found){
+            emit_bool(0);
+            return 1;
+        }
+
+        /// Check if relation's domain and codomain have unique elements
+        if ((row_offsets[domain + 1] > i + 1) ||
+            (column_offsets[codomain + 1] > i + 1)){
+            emit_bool(0);
+            return 1;
+        }
+    }
+
+    emit_bool(1);
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints:
+ * true - relation is transitive
+ * false - in other case
+ *
+ * @param[in] relation_list
+ * @param[in] row_number
+ * @return 0 - there isn't relation on the row, 1 - in other case
+ */
+static int is_transitive(Relation_list *relation_list, int row_number)
+{
+    if (!check_relation_existence(relation_list, &row_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Relation *relation = &relation_list->relations[row_number];
+
+    /// For every pair (a b) and every pair (b c) there has to be pair (a c)
+    for (int i = 0; i < relation->number_of_pairs; i++){
+        int middle = relation->second[i];
+        for (int j = relation->row_offsets[middle]; j < relation->row_offsets[middle + 1]; j++){
+            if (!relation_contains(relation, relation->first[i], relation->columns[j])){
+                emit_bool(0);
+                return 1;
+            }
+        }
+    }
+
+    emit_bool(1);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function returns number of 64-bit words of bitset over universe
+ *
+ * @param[in] set_list
+ * @return number of words
+ */
+static int bitset_words(Set_list *set_list)
+{
+    return (set_list->sets[0].cardinality + 63) / 64;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function builds adjacency of relation over indexes of elements in universe.
+ * Targets of source i are targets[offsets[i]] ... targets[offsets[i + 1] - 1]
+ * in ascending order.
+ *
+ * @param[in] offsets - array of size of universe + 1 filled with zeros
+ * @param[in] targets - array of number of pairs
+ * @param[in] sources - source of every pair
+ * @param[in] ends - target of every pair
+ * @param[out] slots - position of pair of every target in sources, NULL - positions aren't needed
+ * @param[in] order - scratch array of number of pairs
+ * @param[in] cursor - scratch array of size of universe + 1
+ * @param[in] size_of_universe
+ * @param[in] number_of_pairs
+ */
+static void fill_adjacency(int *offsets, int *targets, int *sources, int *ends, int *slots, int *order, int *cursor,
+                           int size_of_universe, int number_of_pairs)
+{
+    /// Pairs are ordered by their ends, so targets of every source end up sorted
+    memset(cursor, 0, sizeof(int) * (size_of_universe + 1));
+    for (int i = 0; i < number_of_pairs; i++){
+        cursor[ends[i] + 1]++;
+    }
+    for (int i = 0; i < size_of_universe; i++){
+        cursor[i + 1] += cursor[i];
+    }
+    for (int i = 0; i < number_of_pairs; i++){
+        order[cursor[ends[i]]++] = i;
+    }
+
+    for (int i = 0; i < number_of_pairs; i++){
+        offsets[sources[i] + 1]++;
+    }
+    for (int i = 0; i < size_of_universe; i++){
+        offsets[i + 1] += offsets[i];
+    }
+
+    memcpy(cursor, offsets, sizeof(int) * (size_of_universe + 1));
+    for (int i = 0; i < number_of_pairs; i++){
+        int pair = order[i];
+        if (slots != NULL){
+            slots[cursor[sources[pair]]] = pair;
+        }
+        targets[cursor[sources[pair]]++] = ends[pair];
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function computes 64-bit hash of pair of indexes of elements
+ *
+ * @param[in] first
+ * @param[in] second
+ * @return hash of pair
+ */
+static unsigned long long pair_hash(int first, int second)
+{
+    unsigned long long hash = ((unsigned long long) first << 32) | (unsigned) second;
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function computes hash of content of relation as sum of hashes of its pairs,
+ * so it can be updated when one pair is added or deleted
+ *
+ * @param[in] relation
+ * @return hash of relation
+ */
+static unsigned long long relation_hash(Relation *relation)
+{
+    unsigned long long hash = 0;
+    for (int i = 0; i < relation->number_of_pairs; i++){
+        hash += pair_hash(relation->first[i], relation->second[i]);
+    }
+
+    return hash;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function compiles relation into forward (CSR) and reverse (CSC) adjacency
+ * over indexes of elements in universe and computes hash of relation
+ *
+ * @param[in] relation
+ * @param[in] set_list
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int build_adjacency(Relation *relation, Set_list *set_list)
+{
+    int size_of_universe = set_list->sets[0].cardinality;
+    int number_of_pairs = relation->number_of_pairs;
+
+    relation->row_offsets = (int *) calloc(size_of_universe + 1, sizeof(int));
+    relation->column_offsets = (int *) calloc(size_of_universe + 1, sizeof(int));
+    relation->columns = (int *) malloc(sizeof(int) * (relation->capacity + 1));
+    relation->slots = (int *) malloc(sizeof(int) * (relation->capacity + 1));
+    relation->rows = (int *) malloc(sizeof(int) * (relation->capacity + 1));
+
+    /// Order of pairs and cursors of adjacency
+    int *order = (int *) malloc(sizeof(int) * (number_of_pairs + size_of_universe + 1));
+
+    if (relation->row_offsets == NULL || relation->column_offsets == NULL || relation->columns == NULL ||
+        relation->slots == NULL || relation->rows == NULL || order == NULL){
+        free(order);
+        fprintf(error_output(), "Not enough memory!\n");
+        return 0;
+    }
+
+    int *cursor = order + number_of_pairs;
+    fill_adjacency(relation->row_offsets, relation->columns, relation->first, relation->second, relation->slots,
+                   order, cursor, size_of_universe, number_of_pairs);
+    fill_adjacency(relation->column_offsets, relation->rows, relation->second, relation->first, NULL,
+                   order, cursor, size_of_universe, number_of_pairs);
+
+    free(order);
+
+    /// Targets of every source are sorted, so repeated pair is next to its copy
+    for (int i = 0; i < size_of_universe; i++){
+        for (int j = relation->row_offsets[i] + 1; j < relation->row_offsets[i + 1]; j++){
+            if (relation->columns[j - 1] == relation->columns[j]){
+                fprintf(error_output(), "Pair was already stored!\n");
+                return 0;
+            }
+        }
+    }
+    relation->hash = relation_hash(relation);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function builds adjacency of relation again with pairs added and deleted
+ * after it was built, deleted pairs are removed from first and second.
+ * Relation is left unchanged if there isn't enough memory.
+ *
+ * @param[in] relation
+ * @param[in] set_list
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int merge_pending(Relation *relation, Set_list *set_list)
+{
+    if (relation->number_of_pending == 0 && relation->deleted == 0){
+        return 1;
+    }
+
+    Relation merged = *relation;
+    merged.first = (int *) malloc(sizeof(int) * relation->capacity);
+    merged.second = (int *) malloc(sizeof(int) * relation->capacity);
+    if (merged.first == NULL || merged.second == NULL){
+        free(merged.first);
+        free(merged.second);
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+
+    int size = 0;
+    for (int i = 0; i < relation->number_of_pairs + relation->deleted; i++){
+        if (relation->first[i] >= 0){
+            merged.first[size] = relation->first[i];
+            merged.second[size] = relation->second[i];
+            size++;
+        }
+    }
+    merged.deleted = 0;
+
+    if (!build_adjacency(&merged, set_list)){
+        free(merged.first);
+        free(merged.second);
+        free(merged.row_offsets);
+        free(merged.columns);
+        free(merged.slots);
+        free(merged.column_offsets);
+        free(merged.rows);
+        return 0;
+    }
+
+    free(relation->first);
+    free(relation->second);
+    free(relation->row_offsets);
+    free(relation->columns);
+    free(relation->slots);
+    free(relation->column_offsets);
+    free(relation->rows);
+    free(relation->pending);
+    merged.pending = NULL;
+    merged.number_of_pending = 0;
+    merged.pending_capacity = 0;
+    *relation = merged;
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function builds adjacency of every changed relation again,
+ * commands other than addpair and delpair read adjacency only
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int merge_relations(Relation_list *relation_list, Set_list *set_list)
+{
+    for (int i = 0; i < relation_list->size; i++){
+        if (!merge_pending(&relation_list->relations[i], set_list)){
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints image R[A] or preimage R^-1[B] of set. Only adjacency of
+ * elements of set is visited.
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number
+ * @param[in] set_number
+ * @param[in] inverse 0 - image, 1 - preimage
+ * @return 0 - error, 1 - in other case
+ */
+static int relation_image(Relation_list *relation_list, Set_list *set_list, int relation_number, int set_number, int inverse)
+{
+    if (!check_relation_existence(relation_list, &relation_number) ||
+        !check_set_existence(set_list, &set_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Relation *relation = &relation_list->relations[relation_number];
+    Set *set = &set_list->sets[set_number];
+    int *offsets = inverse ? relation->column_offsets : relation->row_offsets;
+    int *targets = inverse ? relation->rows : relation->columns;
+
+    int words = bitset_words(set_list);
+    unsigned long long *found = (unsigned long long *) calloc(words + 1, sizeof(unsigned long long));
+    int *image = (int *) malloc(sizeof(int) * (relation->number_of_pairs + 1));
+    if (found == NULL || image == NULL){
+        free(found);
+        free(image);
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+
+    int size = 0;
+    for (int i = 0; i < set->cardinality; i++){
+        int source = universe_index(set_list, set->elements[i]);
+        for (int j = offsets[source]; j < offsets[source + 1]; j++){
+            int target = targets[j];
+            if (!(found[target / 64] & (1ULL << (target % 64)))){
+                found[target / 64] |= 1ULL << (target % 64);
+                image[size++] = target;
+            }
+        }
+    }
+
+    qsort(image, size, sizeof(int), int_comparator);
+
+    emit_set_begin('S');
+    for (int i = 0; i < size; i++){
+        emit_element(set_list, image[i]);
+    }
+    emit_set_end(set_list);
+
+    free(found);
+    free(image);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints composition of relations {(a c) | (a b) in R, (b c) in S}.
+ * Rows of R are joined with rows of S in forward adjacency, elements already
+ * found in current row are marked in bitset, so the work is proportional
+ * to number of joined pairs.
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number_1 - R
+ * @param[in] relation_number_2 - S
+ * @return 0 - error, 1 - in other case
+ */
+static int relation_compose(Relation_list *relation_list, Set_list *set_list, int relation_number_1, int relation_number_2)
+{
+    if (!check_relation_existence(relation_list, &relation_number_1) ||
+        !check_relation_existence(relation_list, &relation_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Relation *first = &relation_list->relations[relation_number_1];
+    Relation *second = &relation_list->relations[relation_number_2];
+    int size_of_universe = set_list->sets[0].cardinality;
+
+    unsigned long long *found = (unsigned long long *) calloc(bitset_words(set_list) + 1, sizeof(unsigned long long));
+    int *row = (int *) malloc(sizeof(int) * (size_of_universe + 1));
+    if (found == NULL || row == NULL){
+        free(found);
+        free(row);
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+
+    emit_relation_begin();
+    for (int a = 0; a < size_of_universe; a++){
+        int size = 0;
+        for (int i = first->row_offsets[a]; i < first->row_offsets[a + 1]; i++){
+            int b = first->columns[i];
+            for (int j = second->row_offsets[b]; j < second->row_offsets[b + 1]; j++){
+                int c = second->columns[j];
+                if (!(found[c / 64] & (1ULL << (c % 64)))){
+                    found[c / 64] |= 1ULL << (c % 64);
+                    row[size++] = c;
+                }
+            }
+        }
+
+        /// Only bits of current row are cleared
+        for (int i = 0; i < size; i++){
+            emit_pair(set_list, a, row[i]);
+            found[row[i] / 64] &= ~(1ULL << (row[i] % 64));
+        }
+    }
+    emit_relation_end();
+
+    free(found);
+    free(row);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints inverse relation R^-1. Reverse adjacency of relation
+ * is its transpose, so pairs are read from it in sorted order.
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number
+ * @return 0 - error, 1 - in other case
+ */
+static int relation_inverse(Relation_list *relation_list, Set_list *set_list, int relation_number)
+{
+    if (!check_relation_existence(relation_list, &relation_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Relation *relation = &relation_list->relations[relation_number];
+    int size_of_universe = set_list->sets[0].cardinality;
+
+    emit_relation_begin();
+    for (int b = 0; b < size_of_universe; b++){
+        for (int i = relation->column_offsets[b]; i < relation->column_offsets[b + 1]; i++){
+            emit_pair(set_list, b, relation->rows[i]);
+        }
+    }
+    emit_relation_end();
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints union, intersection or difference of relations, or whether
+ * the first relation is subseteq of the second one. Forward adjacency visits
+ * pairs in order of (first, second), i.e. in order of packed 64-bit keys,
+ * so both relations are merged linearly row by row and nothing is sorted.
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] command - RUNION, RINTERSECT, RMINUS or RSUBSETEQ
+ * @param[in] relation_number_1
+ * @param[in] relation_number_2
+ * @return 0 - error, 1 - in other case
+ */
+static int relation_algebra(Relation_list *relation_list, Set_list *set_list, int command,
+                            int relation_number_1, int relation_number_2)
+{
+    if (!check_relation_existence(relation_list, &relation_number_1) ||
+        !check_relation_existence(relation_list, &relation_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Relation *first = &relation_list->relations[relation_number_1];
+    Relation *second = &relation_list->relations[relation_number_2];
+    int size_of_universe = set_list->sets[0].cardinality;
+
+    if (command == RSUBSETEQ){
+        /// Subseteq can't be greater than superset, identical relations share arrays
+        int is_subseteq = first->number_of_pairs <= second->number_of_pairs;
+        if (is_subseteq && first->columns != second->columns){
+            for (int a = 0; a < size_of_universe && is_subseteq; a++){
+                int j = second->row_offsets[a];
+                for (int i = first->row_offsets[a]; i < first->row_offsets[a + 1] && is_subseteq; i++){
+                    while (j < second->row_offsets[a + 1] && second->columns[j] < first->columns[i]){
+                        j++;
+                    }
+                    is_subseteq = j < second->row_offsets[a + 1] && second->columns[j] == first->columns[i];
+                }
+            }
+        }
+        emit_bool(is_subseteq);
+        return 1;
+    }
+
+    emit_relation_begin();
+    for (int a = 0; a < size_of_universe; a++){
+        int i = first->row_offsets[a];
+        int j = second->row_offsets[a];
+        int i_end = first->row_offsets[a + 1];
+        int j_end = second->row_offsets[a + 1];
+
+        while (i < i_end || j < j_end){
+            int in_first = (j == j_end) || (i < i_end && first->columns[i] <= second->columns[j]);
+            int in_second = (i == i_end) || (j < j_end && second->columns[j] <= first->columns[i]);
+            int c = in_first ? first->columns[i] : second->columns[j];
+            i += in_first;
+            j += in_second;
+
+            if ((command == RUNION) || (command == RINTERSECT && in_first && in_second) ||
+                (command == RMINUS && in_first && !in_second)){
+                emit_pair(set_list, a, c);
+            }
+        }
+    }
+    emit_relation_end();
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints on one line whether relation is reflexive, symmetric,
+ * antisymmetric, transitive and function, and sizes of its domain and codomain.
+ * All properties are computed from rows of adjacency, which are sorted.
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] row_number
+ * @return 0 - error, 1 - in other case
+ */
+static int relation_profile(Relation_list *relation_list, Set_list *set_list, int row_number)
+{
+    if (!check_relation_existence(relation_list, &row_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Relation *relation = &relation_list->relations[row_number];
+    int *row_offsets = relation->row_offsets;
+    int *columns = relation->columns;
+    int size_of_universe = set_list->sets[0].cardinality;
+
+    int reflexive_pairs = 0;
+    int symmetric = 1;
+    int antisymmetric = 1;
+    int transitive = 1;
+    int function = 1;
+    int domain_size = 0;
+    int codomain_size = 0;
+
+    for (int first = 0; first < size_of_universe; first++){
+        int size_of_row = row_offsets[first + 1] - row_offsets[first];
+        domain_size += size_of_row > 0;
+        codomain_size += relation->column_offsets[first + 1] > relation->column_offsets[first];
+        if (size_of_row > 1){
+            function = 0;
+        }
+
+        for (int i = row_offsets[first]; i < row_offsets[first + 1]; i++){
+            int second = columns[i];
+            if (first == second){
+                reflexive_pairs++;
+            }
+            else if (relation_contains(relation, second, first)){
+                antisymmetric = 0;
+            }
+            else {
+                symmetric = 0;
+            }
+
+            /// Every pair (second, x) requires pair (first, x)
+            for (int j = row_offsets[second]; transitive && j < row_offsets[second + 1]; j++){
+                if (!relation_contains(relation, first, columns[j])){
+                    transitive = 0;
+                }
+            }
+        }
+    }
+
+    emit_text("reflexive %s symmetric %s antisymmetric %s transitive %s function %s domain %d codomain %d\n",
+           reflexive_pairs == size_of_universe ? "true" : "false",
+           symmetric ? "true" : "false",
+           antisymmetric ? "true" : "false",
+           transitive ? "true" : "false",
+           function ? "true" : "false",
+           domain_size, codomain_size);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function computes 64-bit hash of element (FNV-1a with final avalanche)
+ *
+ * @param[in] element
+ * @return hash of element
+ */
+static unsigned long long element_hash(const char *element)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (int i = 0; element[i] != '\0'; i++){
+        hash ^= (unsigned char) element[i];
+        hash *= 1099511628211ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function computes hash of content of set as sum of hashes of its elements and
+ * signature of set, in which every element sets one of 64 bits. Set A can be
+ * subseteq of set B only if signature of A has no bit missing in signature of B.
+ *
+ * @param[in] set
+ */
+static void set_fingerprint(Set *set)
+{
+    set->hash = 0;
+    set->signature = 0;
+    for (int i = 0; i < set->cardinality; i++){
+        unsigned long long hash = element_hash(set->elements[i]);
+        set->hash += hash;
+        set->signature |= 1ULL << (hash & 63);
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function updates hash and signature of set after element was inserted
+ * or erased, elements of set have to be updated already
+ *
+ * @param[in] set
+ * @param[in] element
+ * @param[in] erase 0 - element was inserted, 1 - element was erased
+ */
+static void fingerprint_update(Set *set, const char *element, int erase)
+{
+    unsigned long long hash = element_hash(element);
+
+    if (!erase){
+        set->hash += hash;
+        set->signature |= 1ULL << (hash & 63);
+        return;
+    }
+
+    /// Bit is kept if other element of set chooses it too
+    set->hash -= hash;
+    set->signature &= ~(1ULL << (hash & 63));
+    for (int i = 0; i < set->cardinality; i++){
+        if ((element_hash(set->elements[i]) & 63) == (hash & 63)){
+            set->signature |= 1ULL << (hash & 63);
+            break;
+        }
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function adds element to HyperLogLog sketch
+ *
+ * @param[in] sketch
+ * @param[in] element
+ */
+static void sketch_add(unsigned char *sketch, const char *element)
+{
+    unsigned long long hash = element_hash(element);
+    unsigned long long rest = hash << HLL_PRECISION;
+    unsigned char rank = rest ? __builtin_clzll(rest) + 1 : 64 - HLL_PRECISION + 1;
+    unsigned long long reg = hash >> (64 - HLL_PRECISION);
+
+    if (rank > sketch[reg]){
+        sketch[reg] = rank;
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function builds HyperLogLog sketch of set with HLL_REGISTERS registers
+ *
+ * @param[in] set
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int build_sketch(Set *set)
+{
+    set->sketch = (unsigned char *) calloc(HLL_REGISTERS, sizeof(unsigned char));
+    if (set->sketch == NULL){
+        fprintf(error_output(), "Not enough memory!\n");
+        return 0;
+    }
+
+    for (int i = 0; i < set->cardinality; i++){
+        sketch_add(set->sketch, set->elements[i]);
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function estimates cardinality of union of sketches, second sketch can be NULL
+ *
+ * @param[in] sketch_1
+ * @param[in] sketch_2
+ * @return estimated number of distinct elements
+ */
+static double sketch_estimate(unsigned char *sketch_1, unsigned char *sketch_2)
+{
+    double sum = 0;
+    int zero_registers = 0;
+
+    for (int i = 0; i < HLL_REGISTERS; i++){
+        unsigned char rank = sketch_1[i];
+        if (sketch_2 != NULL && sketch_2[i] > rank){
+            rank = sketch_2[i];
+        }
+        sum += ldexp(1.0, -rank);
+        if (rank == 0){
+            zero_registers++;
+        }
+    }
+
+    double m = HLL_REGISTERS;
+    double estimate = (0.7213 / (1 + 1.079 / m)) * m * m / sum;
+
+    /// Linear counting is more precise for small cardinalities
+    if (estimate <= 2.5 * m && zero_registers > 0){
+        estimate = m * log(m / zero_registers);
+    }
+
+    return estimate;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints approximate number of elements in set
+ *
+ * @param[in] set_list
+ * @param[in] set_number
+ * @return 0 - error, 1 - given set number is valid
+ */
+static int approximate_card(Set_list *set_list, int set_number)
+{
+    if (!check_set_existence(set_list, &set_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    emit_number((unsigned long long) nearbyint(sketch_estimate(set_list->sets[set_number].sketch, NULL)));
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints approximate number of elements in union of sets,
+ * sketches of sets are merged without materializing the union
+ *
+ * @param[in] set_list
+ * @param[in] set_number_1
+ * @param[in] set_number_2
+ * @return 0 - error, 1 - given set numbers are valid
+ */
+static int approximate_union_card(Set_list *set_list, int set_number_1, int set_number_2)
+{
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    emit_number((unsigned long long) nearbyint(sketch_estimate(set_list->sets[set_number_1].sketch,
+                                                               set_list->sets[set_number_2].sketch)));
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function builds bitset of set, bit i is set if set contains i-th element of universe.
+ * Set which is added to empty list is universe.
+ *
+ * @param[in] set_list
+ * @param[in] set
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int build_bitset(Set_list *set_list, Set *set)
+{
+    int is_universe = (set_list->size == 0);
+    int words = ((is_universe ? set->cardinality : set_list->sets[0].cardinality) + 63) / 64;
+
+    set->bitset = (unsigned long long *) calloc(words + 1, sizeof(unsigned long long));
+    if (set->bitset == NULL){
+        fprintf(error_output(), "Not enough memory!\n");
+        return 0;
+    }
+
+    for (int i = 0; i < set->cardinality; i++){
+        int index = is_universe ? i : universe_index(set_list, set->elements[i]);
+        set->bitset[index / 64] |= 1ULL << (index % 64);
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function returns bitset of set, sets with other representation get it
+ * built on demand
+ *
+ * @param[in] set_list
+ * @param[in] set
+ * @return bitset, NULL - not enough memory
+ */
+static unsigned long long *set_bitset(Set_list *set_list, Set *set)
+{
+    if (set->bitset != NULL){
+        return set->bitset;
+    }
+    if (!build_bitset(set_list, set)){
+        return NULL;
+    }
+
+    /// Identical sets share the bitset too
+    if (set->references != NULL){
+        for (int i = 1; i < set_list->size; i++){
+            if (set_list->sets[i].references == set->references){
+                set_list->sets[i].bitset = set->bitset;
+            }
+        }
+    }
+
+    return set->bitset;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function chooses representation of set by its density. Sizes of sorted
+ * array of indexes (4 bytes per element), bitset (8 bytes per word of
+ * universe) and ranges (8 bytes per range) are compared, the smallest one
+ * is kept, because kernels over it scan the least memory. Universe is
+ * always bitset, it is mask of complements.
+ *
+ * @param[in] set_list
+ * @param[in] set
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int choose_representation(Set_list *set_list, Set *set)
+{
+    int is_universe = (set_list->size == 0) || (set == &set_list->sets[0]);
+    int size_of_universe = is_universe ? set->cardinality : set_list->sets[0].cardinality;
+
+    free(set->ids);
+    free(set->bitset);
+    free(set->runs);
+    set->ids = NULL;
+    set->bitset = NULL;
+    set->runs = NULL;
+    set->number_of_runs = 0;
+
+    if (is_universe){
+        set->representation = SET_BITSET;
+        return build_bitset(set_list, set);
+    }
+
+    int *ids = (int *) malloc(sizeof(int) * (set->capacity + 1));
+    if (ids == NULL){
+        fprintf(error_output(), "Not enough memory!\n");
+        return 0;
+    }
+
+    int number_of_runs = 0;
+    for (int i = 0; i < set->cardinality; i++){
+        ids[i] = universe_index(set_list, set->elements[i]);
+        if (i == 0 || ids[i] != ids[i - 1] + 1){
+            number_of_runs++;
+        }
+    }
+    set->number_of_runs = number_of_runs;
+
+    long array_size = 4L * set->cardinality;
+    long bitset_size = 8L * ((size_of_universe + 63) / 64);
+    long runs_size = 8L * number_of_runs;
+
+    if (array_size <= bitset_size && array_size <= runs_size){
+        set->representation = SET_ARRAY;
+        set->ids = ids;
+        return 1;
+    }
+
+    if (bitset_size <= runs_size){
+        free(ids);
+        set->representation = SET_BITSET;
+        return build_bitset(set_list, set);
+    }
+
+    set->runs = (int *) malloc(sizeof(int) * 2 * number_of_runs);
+    if (set->runs == NULL){
+        free(ids);
+        fprintf(error_output(), "Not enough memory!\n");
+        return 0;
+    }
+    int run = 0;
+    for (int i = 0; i < set->cardinality; i++){
+        if (i == 0 || ids[i] != ids[i - 1] + 1){
+            set->runs[2 * run] = ids[i];
+            run++;
+        }
+        set->runs[2 * run - 1] = ids[i] + 1;
+    }
+    set->representation = SET_RUNS;
+    free(ids);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function updates representation of set after element was inserted to its
+ * sorted elements at position or erased from there. Index is moved in sorted
+ * array, bit is flipped in bitset, range is extended, shortened, split or
+ * merged. Representation is chosen again only if it becomes twice as large
+ * as the smallest one, so set changing back and forth isn't rebuilt.
+ *
+ * @param[in] set_list
+ * @param[in] set
+ * @param[in] position
+ * @param[in] id - index of element in universe
+ * @param[in] erase 0 - element was inserted, 1 - element was erased
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int update_representation(Set_list *set_list, Set *set, int position, int id, int erase)
+{
+    Set *universe = &set_list->sets[0];
+    int next = erase ? position : position + 1;
+    int left = position > 0 && id > 0 &&
+               set->elements[position - 1] == universe->elements[id - 1];
+    int right = next < set->cardinality && id + 1 < universe->cardinality &&
+                set->elements[next] == universe->elements[id + 1];
+
+    /// Element joins or splits ranges of its neighbours
+    int runs_change = erase ? left + right - 1 : 1 - left - right;
+
+    if (set->representation == SET_ARRAY){
+        if (erase){
+            memmove(set->ids + position, set->ids + position + 1,
+                    sizeof(int) * (set->cardinality - position));
+        }
+        else {
+            memmove(set->ids + position + 1, set->ids + position,
+                    sizeof(int) * (set->cardinality - 1 - position));
+            set->ids[position] = id;
+        }
+    }
+
+    if (set->bitset != NULL){
+        set->bitset[id / 64] ^= 1ULL << (id % 64);
+    }
+
+    if (set->representation == SET_RUNS){
+        if (runs_change > 0){
+            int *runs = (int *) realloc(set->runs, sizeof(int) * 2 * (set->number_of_runs + 1));
+            if (runs == NULL){
+                fprintf(stderr, "Not enough memory!\n");
+                return 0;
+            }
+            set->runs = runs;
+        }
+
+        /// Number of ranges starting at element or before it
+        int run = 0;
+        int high = set->number_of_runs;
+        while (run < high){
+            int middle = run + (high - run) / 2;
+            if (set->runs[2 * middle] <= id){
+                run = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+
+        int *runs = set->runs;
+        int tail = set->number_of_runs - run;
+        if (!erase){
+            if (left && right){
+                runs[2 * run - 1] = runs[2 * run + 1];
+                memmove(runs + 2 * run, runs + 2 * run + 2, sizeof(int) * 2 * (tail - 1));
+            }
+            else if (left){
+                runs[2 * run - 1]++;
+            }
+            else if (right){
+                runs[2 * run]--;
+            }
+            else {
+                memmove(runs + 2 * run + 2, runs + 2 * run, sizeof(int) * 2 * tail);
+                runs[2 * run] = id;
+                runs[2 * run + 1] = id + 1;
+            }
+        }
+        else {
+            /// Element is in the last range starting before it
+            run--;
+            if (left && right){
+                memmove(runs + 2 * run + 2, runs + 2 * run, sizeof(int) * 2 * (tail + 1));
+                runs[2 * run + 1] = id;
+                runs[2 * run + 2] = id + 1;
+            }
+            else if (left){
+                runs[2 * run + 1]--;
+            }
+            else if (right){
+                runs[2 * run]++;
+            }
+            else {
+                memmove(runs + 2 * run, runs + 2 * run + 2, sizeof(int) * 2 * tail);
+            }
+        }
+    }
+    set->number_of_runs += runs_change;
+
+    long sizes[3];
+    sizes[SET_ARRAY] = 4L * set->cardinality;
+    sizes[SET_BITSET] = 8L * ((universe->cardinality + 63) / 64);
+    sizes[SET_RUNS] = 8L * set->number_of_runs;
+
+    long smallest = sizes[SET_ARRAY];
+    for (int i = SET_BITSET; i <= SET_RUNS; i++){
+        if (sizes[i] < smallest){
+            smallest = sizes[i];
+        }
+    }
+    if (sizes[set->representation] > 2 * smallest){
+        return choose_representation(set_list, set);
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Constructor for cursor walking elements of set in ascending order
+ *
+ * @param[in] cursor
+ * @param[in] set
+ */
+static void set_cursor_ctor(Set_cursor *cursor, Set *set)
+{
+    cursor->set = set;
+    cursor->position = 0;
+    cursor->next = set->representation == SET_RUNS && set->number_of_runs > 0 ? set->runs[0] : 0;
+    cursor->word = set->representation == SET_BITSET && set->cardinality > 0 ? set->bitset[0] : 0;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function moves cursor to next element of set
+ *
+ * @param[in] cursor
+ * @param[out] id - index of element in universe
+ * @return 0 - there are no more elements, 1 - in other case
+ */
+static int set_cursor_next(Set_cursor *cursor, int *id)
+{
+    Set *set = cursor->set;
+
+    switch (set->representation){
+        case SET_ARRAY:
+            if (cursor->position == set->cardinality){
+                return 0;
+            }
+            *id = set->ids[cursor->position++];
+            return 1;
+        case SET_RUNS:
+            if (cursor->position == set->number_of_runs){
+                return 0;
+            }
+            *id = cursor->next++;
+            if (cursor->next == set->runs[2 * cursor->position + 1]){
+                cursor->position++;
+                if (cursor->position < set->number_of_runs){
+                    cursor->next = set->runs[2 * cursor->position];
+                }
+            }
+            return 1;
+        default:
+            /// Cursor counts returned elements, so words after the last element are never read
+            if (cursor->next == set->cardinality){
+                return 0;
+            }
+            while (cursor->word == 0){
+                cursor->word = set->bitset[++cursor->position];
+            }
+            *id = cursor->position * 64 + __builtin_ctzll(cursor->word);
+            cursor->word &= cursor->word - 1;
+            cursor->next++;
+            return 1;
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function checks whether set contains element. Elements have to be probed
+ * in ascending order, position remembers where the previous probe ended,
+ * sorted array is searched by galloping from it.
+ *
+ * @param[in] set
+ * @param[in] position - 0 before the first probe
+ * @param[in] id - index of element in universe
+ * @return 1 - set contains element, 0 - in other case
+ */
+static int set_probe(Set *set, int *position, int id)
+{
+    if (set->bitset != NULL){
+        return (set->bitset[id / 64] >> (id % 64)) & 1;
+    }
+
+    if (set->representation == SET_RUNS){
+        while (*position < set->number_of_runs && set->runs[2 * *position + 1] <= id){
+            (*position)++;
+        }
+        return *position < set->number_of_runs && set->runs[2 * *position] <= id;
+    }
+
+    int low = *position;
+    int step = 1;
+    while (low + step < set->cardinality && set->ids[low + step] < id){
+        low += step;
+        step *= 2;
+    }
+    int high = low + step < set->cardinality ? low + step : set->cardinality;
+    while (low < high){
+        int middle = low + (high - low) / 2;
+        if (set->ids[middle] < id){
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    *position = low;
+
+    return low < set->cardinality && set->ids[low] == id;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function walks elements of first set and checks whether second set contains them.
+ * Kernel is chosen by representations of both sets: words of two bitsets
+ * are combined directly, two sets of ranges are merged range by range,
+ * other combinations probe second set with elements of first one.
+ *
+ * @param[in] set_list
+ * @param[in] first
+ * @param[in] second
+ * @param[in] keep 1 - elements contained in second set, 0 - elements missing in second set
+ * @param[in] print 1 - print kept elements, 0 - stop at the first kept element
+ * @return number of kept elements (at most 1 if they aren't printed)
+ */
+static int set_filter(Set_list *set_list, Set *first, Set *second, int keep, int print)
+{
+    int count = 0;
+
+    if (first->representation == SET_BITSET && second->representation == SET_BITSET){
+        int words = bitset_words(set_list);
+        for (int w = 0; w < words; w++){
+            unsigned long long word = keep ? first->bitset[w] & second->bitset[w] : first->bitset[w] & ~second->bitset[w];
+            if (word && !print){
+                return 1;
+            }
+            while (word){
+                emit_element(set_list, w * 64 + __builtin_ctzll(word));
+                count++;
+                word &= word - 1;
+            }
+        }
+        return count;
+    }
+
+    if (first->representation == SET_RUNS && second->representation == SET_RUNS){
+        int j = 0;
+        for (int i = 0; i < first->number_of_runs; i++){
+            int id = first->runs[2 * i];
+            int end = first->runs[2 * i + 1];
+            while (id < end){
+                while (j < second->number_of_runs && second->runs[2 * j + 1] <= id){
+                    j++;
+                }
+                /// Elements up to stop are all inside or all outside of second set
+                int inside = j < second->number_of_runs && second->runs[2 * j] <= id;
+                int stop = end;
+                if (inside && second->runs[2 * j + 1] < end){
+                    stop = second->runs[2 * j + 1];
+                }
+                else if (!inside && j < second->number_of_runs && second->runs[2 * j] < end){
+                    stop = second->runs[2 * j];
+                }
+
+                if (inside == keep){
+                    if (!print){
+                        return 1;
+                    }
+                    for (int k = id; k < stop; k++){
+                        emit_element(set_list, k);
+                    }
+                    count += stop - id;
+                }
+                id = stop;
+            }
+        }
+        return count;
+    }
+
+    Set_cursor cursor;
+    set_cursor_ctor(&cursor, first);
+    int position = 0;
+    int id;
+    while (set_cursor_next(&cursor, &id)){
+        if (set_probe(second, &position, id) == keep){
+            if (!print){
+                return 1;
+            }
+            emit_element(set_list, id);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function of similarity worker thread, takes rows of tiles and counts
+ * sizes of intersections of all pairs of sets in them
+ *
+ * @param[in] arg - pointer to Similarity
+ * @return NULL
+ */
+static void *similarity_worker(void *arg)
+{
+    Similarity *similarity = (Similarity *) arg;
+    int n = similarity->number_of_sets;
+    int words = similarity->words;
+
+    while (1){
+        pthread_mutex_lock(&similarity->lock);
+        int tile = similarity->next_tile;
+        similarity->next_tile += SIMILARITY_TILE;
+        pthread_mutex_unlock(&similarity->lock);
+
+        if (tile >= n){
+            break;
+        }
+        int tile_end = tile + SIMILARITY_TILE < n ? tile + SIMILARITY_TILE : n;
+
+        /// Tiles of sets and words are small enough to stay in cache
+        for (int other = tile; other < n; other += SIMILARITY_TILE){
+            int other_end = other + SIMILARITY_TILE < n ? other + SIMILARITY_TILE : n;
+
+            for (int w = 0; w < words; w += SIMILARITY_WORDS){
+                int w_end = w + SIMILARITY_WORDS < words ? w + SIMILARITY_WORDS : words;
+
+                for (int i = tile; i < tile_end; i++){
+                    unsigned long long *a = similarity->bitsets[i];
+                    for (int j = (other > i + 1 ? other : i + 1); j < other_end; j++){
+                        unsigned long long *b = similarity->bitsets[j];
+                        int count = 0;
+                        for (int k = w; k < w_end; k++){
+                            count += __builtin_popcountll(a[k] & b[k]);
+                        }
+                        similarity->intersections[(long) i * n + j] += count;
+                    }
+                }
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function computes Jaccard index of pair of sets
+ *
+ * @param[in] similarity
+ * @param[in] i
+ * @param[in] j
+ * @return Jaccard index, 1 for two empty sets
+ */
+static double jaccard_index(Similarity *similarity, int i, int j)
+{
+    int intersection = i < j ? similarity->intersections[(long) i * similarity->number_of_sets + j]
+                             : similarity->intersections[(long) j * similarity->number_of_sets + i];
+    int set_union = similarity->cardinalities[i] + similarity->cardinalities[j] - intersection;
+
+    if (set_union == 0){
+        return 1;
+    }
+
+    return (double) intersection / set_union;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints Jaccard index of all pairs of defined sets as (A B index),
+ * or only top_k most similar sets for every set
+ *
+ * @param[in] set_list
+ * @param[in] top_k - 0 prints all pairs
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int sets_similarity(Set_list *set_list, int top_k)
+{
+    Similarity similarity;
+    similarity.number_of_sets = set_list->size - 1;
+    similarity.words = bitset_words(set_list);
+    similarity.next_tile = 0;
+
+    int n = similarity.number_of_sets;
+    similarity.bitsets = (unsigned long long **) malloc(sizeof(unsigned long long *) * (n + 1));
+    similarity.cardinalities = (int *) malloc(sizeof(int) * (n + 1));
+    similarity.intersections = (int *) calloc((long) n * n + 1, sizeof(int));
+    if (similarity.bitsets == NULL || similarity.cardinalities == NULL || similarity.intersections == NULL){
+        free(similarity.bitsets);
+        free(similarity.cardinalities);
+        free(similarity.intersections);
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+
+    /// Universe isn't compared
+    for (int i = 0; i < n; i++){
+        similarity.bitsets[i] = set_bitset(set_list, &set_list->sets[i + 1]);
+        similarity.cardinalities[i] = set_list->sets[i + 1].cardinality;
+        if (similarity.bitsets[i] == NULL){
+            free(similarity.bitsets);
+            free(similarity.cardinalities);
+            free(similarity.intersections);
+            return 0;
+        }
+    }
+
+    long number_of_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int number_of_threads = number_of_cpus > 0 ? (int) number_of_cpus : 1;
+    int number_of_tiles = (n + SIMILARITY_TILE - 1) / SIMILARITY_TILE;
+    if (number_of_threads > number_of_tiles){
+        number_of_threads = number_of_tiles > 0 ? number_of_tiles : 1;
+    }
+
+    pthread_mutex_init(&similarity.lock, NULL);
+    pthread_t threads[number_of_threads];
+    int started = 1;
+    for (int i = 1; i < number_of_threads; i++){
+        if (pthread_create(&threads[i], NULL, similarity_worker, &similarity) != 0){
+            break;
+        }
+        started++;
+    }
+    similarity_worker(&similarity);
+    for (int i = 1; i < started; i++){
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&similarity.lock);
+
+    int printed = 0;
+    if (!top_k){
+        for (int i = 0; i < n; i++){
+            for (int j = i + 1; j < n; j++){
+                emit_text(printed++ ? " (%d %d %.4f)" : "(%d %d %.4f)",
+                        set_list->sets[i + 1].position, set_list->sets[j + 1].position,
+                        jaccard_index(&similarity, i, j));
+            }
+        }
+    }
+    else {
+        /// Selection of top_k most similar sets, ties are broken by row number
+        char *used = (char *) malloc(n + 1);
+        if (used == NULL){
+            fprintf(stderr, "Not enough memory!\n");
+            free(similarity.bitsets);
+            free(similarity.cardinalities);
+            free(similarity.intersections);
+            return 0;
+        }
+        for (int i = 0; i < n; i++){
+            memset(used, 0, n);
+            used[i] = 1;
+            for (int k = 0; k < top_k && k < n - 1; k++){
+                int best = -1;
+                for (int j = 0; j < n; j++){
+                    if (!used[j] && (best < 0 || jaccard_index(&similarity, i, j) > jaccard_index(&similarity, i, best))){
+                        best = j;
+                    }
+                }
+                used[best] = 1;
+                emit_text(printed++ ? " (%d %d %.4f)" : "(%d %d %.4f)",
+                        set_list->sets[i + 1].position, set_list->sets[best + 1].position,
+                        jaccard_index(&similarity, i, best));
+            }
+        }
+        free(used);
+    }
+    emit_text("\n");
+
+    free(similarity.bitsets);
+    free(similarity.cardinalities);
+    free(similarity.intersections);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints containment relation among all defined sets as relation
+ * over row numbers, pair (A B) means that A is subseteq of B.
+ * Pairs are rejected by cardinality and by signatures of sets before
+ * elements are compared.
+ *
+ * @param[in] set_list
+ * @return 1 - always
+ */
+static int sets_lattice(Set_list *set_list)
+{
+    int n = set_list->size - 1;
+    Set *sets = set_list->sets + 1;
+
+    emit_text("R");
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++){
+            if ((sets[i].cardinality > sets[j].cardinality) || (sets[i].signature & ~sets[j].signature)){
+                continue;
+            }
+
+            if (sets[i].elements == sets[j].elements || !set_filter(set_list, &sets[i], &sets[j], 0, 0)){
+                emit_text(" (%d %d)", sets[i].position, sets[j].position);
+            }
+        }
+    }
+    emit_text("\n");
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function skips blanks in expression
+ *
+ * @param[in] expression
+ */
+static void skip_blanks(Expression *expression)
+{
+    while (isblank(*expression->cursor)){
+        expression->cursor++;
+    }
+}
+
+/// ======================================================================= ///
+
+static int parse_operands(Expression *expression, int *operands, int number_of_operands);
+
+/**
+ * Function parses set expression, which is row number of set or
+ * union(E, E), intersect(E, E), minus(E, E) or complement(E)
+ *
+ * @param[in] expression
+ * @return index of node, -1 - wrong syntax
+ */
+static int parse_set_expression(Expression *expression)
+{
+    skip_blanks(expression);
+
+    if (expression->size == MAX_EXPRESSION_NODES){
+        fprintf(stderr, "Expression is too long!\n");
+        return -1;
+    }
+    int index = expression->size++;
+    Expression_node *node = &expression->nodes[index];
+    node->left = -1;
+    node->right = -1;
+    node->bitset = NULL;
+
+    if (isdigit(*expression->cursor)){
+        int row = (int) strtol(expression->cursor, &expression->cursor, 10);
+        if (!check_set_existence(expression->set_list, &row)){
+            fprintf(stderr, "Can't step on nonexistent row!\n");
+            return -1;
+        }
+        node->operation = -1;
+        node->bitset = set_bitset(expression->set_list, &expression->set_list->sets[row]);
+        return node->bitset != NULL ? index : -1;
+    }
+
+    char *name = expression->cursor;
+    while (isalpha(*expression->cursor)){
+        expression->cursor++;
+    }
+    int length = (int) (expression->cursor - name);
+
+    if ((length == 5) && (strncmp(name, "union", 5) == 0)){
+        node->operation = UNION;
+    }
+    else if ((length == 9) && (strncmp(name, "intersect", 9) == 0)){
+        node->operation = INTERSECT;
+    }
+    else if ((length == 5) && (strncmp(name, "minus", 5) == 0)){
+        node->operation = MINUS;
+    }
+    else if ((length == 10) && (strncmp(name, "complement", 10) == 0)){
+        node->operation = COMPLEMENT;
+    }
+    else {
+        fprintf(stderr, "Wrong expression syntax!\n");
+        return -1;
+    }
+
+    int number_of_operands = node->operation == COMPLEMENT ? 1 : 2;
+    int operands[2];
+    if (!parse_operands(expression, operands, number_of_operands)){
+        return -1;
+    }
+    expression->nodes[index].left = operands[0];
+    expression->nodes[index].right = operands[1];
+
+    return index;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function parses parenthesised, comma separated operands of operation
+ *
+ * @param[in] expression
+ * @param[out] operands - indexes of nodes of operands
+ * @param[in] number_of_operands
+ * @return 0 - wrong syntax, 1 - in other case
+ */
+static int parse_operands(Expression *expression, int *operands, int number_of_operands)
+{
+    operands[1] = -1;
+
+    skip_blanks(expression);
+    if (*expression->cursor != '('){
+        fprintf(stderr, "Wrong expression syntax!\n");
+        return 0;
+    }
+    expression->cursor++;
+
+    for (int i = 0; i < number_of_operands; i++){
+        if (i > 0){
+            skip_blanks(expression);
+            if (*expression->cursor != ','){
+                fprintf(stderr, "Wrong expression syntax!\n");
+                return 0;
+            }
+            expression->cursor++;
+        }
+        operands[i] = parse_set_expression(expression);
+        if (operands[i] < 0){
+            return 0;
+        }
+    }
+
+    skip_blanks(expression);
+    if (*expression->cursor != ')'){
+        fprintf(stderr, "Wrong expression syntax!\n");
+        return 0;
+    }
+    expression->cursor++;
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function computes one bitset word of result of set expression
+ *
+ * @param[in] expression
+ * @param[in] index - index of node
+ * @param[in] word - index of word
+ * @return word of result
+ */
+static unsigned long long evaluate_word(Expression *expression, int index, int word)
+{
+    Expression_node *node = &expression->nodes[index];
+
+    switch (node->operation){
+        case UNION:
+            return evaluate_word(expression, node->left, word) | evaluate_word(expression, node->right, word);
+        case INTERSECT:
+            return evaluate_word(expression, node->left, word) & evaluate_word(expression, node->right, word);
+        case MINUS:
+            return evaluate_word(expression, node->left, word) & ~evaluate_word(expression, node->right, word);
+        case COMPLEMENT:
+            return ~evaluate_word(expression, node->left, word) & expression->set_list->sets[0].bitset[word];
+        default:
+            return node->bitset[word];
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function evaluates nested expression, e.g. card(union(2, intersect(3, 4))).
+ * Result is computed word by word through the whole expression tree,
+ * so intermediate sets are never stored.
+ *
+ * @param[in] line
+ * @param[in] set_list
+ * @return 0 - error, 1 - in other case
+ */
+static int evaluate_expression(char *line, Set_list *set_list)
+{
+    Expression expression;
+    expression.size = 0;
+    expression.cursor = line;
+    expression.set_list = set_list;
+
+    skip_blanks(&expression);
+    char *name = expression.cursor;
+    while (isalpha(*expression.cursor)){
+        expression.cursor++;
+    }
+    int length = (int) (expression.cursor - name);
+
+    int operation = -1;
+    int number_of_operands = 1;
+    if ((length == 4) && (strncmp(name, "card", 4) == 0)){
+        operation = CARD;
+    }
+    else if ((length == 5) && (strncmp(name, "empty", 5) == 0)){
+        operation = EMPTY;
+    }
+    else if ((length == 8) && (strncmp(name, "subseteq", 8) == 0)){
+        operation = SUBSETEQ;
+        number_of_operands = 2;
+    }
+    else if ((length == 6) && (strncmp(name, "subset", 6) == 0)){
+        operation = SUBSET;
+        number_of_operands = 2;
+    }
+    else if ((length == 6) && (strncmp(name, "equals", 6) == 0)){
+        operation = EQUALS;
+        number_of_operands = 2;
+    }
+
+    int operands[2];
+    if (operation < 0){
+        /// Expression is a set, which is printed
+        expression.cursor = line;
+        operands[0] = parse_set_expression(&expression);
+        if (operands[0] < 0){
+            return 0;
+        }
+    }
+    else if (!parse_operands(&expression, operands, number_of_operands)){
+        return 0;
+    }
+
+    skip_blanks(&expression);
+    if (*expression.cursor != '\0'){
+        fprintf(stderr, "Wrong expression syntax!\n");
+        return 0;
+    }
+
+    int words = bitset_words(set_list);
+    int card = 0;
+    int result = 1;
+    int is_proper = 0;
+
+    if (operation < 0){
+        emit_set_begin('S');
+    }
+
+    for (int w = 0; w < words && result; w++){
+        unsigned long long first = evaluate_word(&expression, operands[0], w);
+        unsigned long long second = number_of_operands == 2 ? evaluate_word(&expression, operands[1], w) : 0;
+
+        switch (operation){
+            case CARD:
+                card += __builtin_popcountll(first);
+                break;
+            case EMPTY:
+                result = first == 0;
+                break;
+            case SUBSETEQ:
+            case SUBSET:
+                result = (first & ~second) == 0;
+                is_proper |= (second & ~first) != 0;
+                break;
+            case EQUALS:
+                result = first == second;
+                break;
+            default:
+                while (first){
+                    int bit = __builtin_ctzll(first);
+                    emit_element(set_list, w * 64 + bit);
+                    first &= first - 1;
+                }
+        }
+    }
+
+    if (operation == CARD){
+        emit_number(card);
+    }
+    else if (operation < 0){
+        emit_set_end(set_list);
+    }
+    else {
+        if (operation == SUBSET){
+            result = result && is_proper;
+        }
+        emit_bool(result);
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints complement of set
+ *
+ * @param[in] set_number
+ * @param[in] set_list
+ * @return 0 - error, 1 - given set number is valid
+ */
+static int set_complement(Set_list* set_list, int set_number)
+{
+    if (!check_set_existence(set_list, &set_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    emit_set_begin('S');
+    set_filter(set_list, &set_list->sets[0], &set_list->sets[set_number], 0, 1);
+    emit_set_end(set_list);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function print number of elements in set
+ *
+ * @param set_list
+ * @param set_number
+ * @return 0 - error, 1 - given set number is valid
+ */
+static int set_card(Set_list *set_list, int set_number)
+{
+    if (!check_set_existence(set_list, &set_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    emit_number(set_list->sets[set_number].cardinality);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function print union of sets
+ *
+ * @param set_list
+ * @param set_number_1
+ * @param set_number_2
+ * @return 0 - error, 1 - given set number is valid
+ */
+static int union_of_sets(Set_list *set_list, int set_number_1, int set_number_2)
+{
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Set *first_set = &set_list->sets[set_number_1];
+    Set *second_set = &set_list->sets[set_number_2];
+
+    /// Elements of first set come first, then elements of second set missing in it
+    emit_set_begin('S');
+    for (int i = 0; i < first_set->cardinality; i++){
+        emit_name(set_list, first_set->elements[i]);
+    }
+    set_filter(set_list, second_set, first_set, 0, 1);
+    emit_set_end(set_list);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints minus of 2 sets
+ *
+ * @param[in] set_list
+ * @param[in] set_number_1
+ * @param[in] set_number_2
+ * @return 0 - error, 1 - given set number is valid
+ */
+static int minus_of_sets(Set_list *set_list, int set_number_1, int set_number_2)
+{
+
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    emit_set_begin('S');
+    set_filter(set_list, &set_list->sets[set_number_1], &set_list->sets[set_number_2], 0, 1);
+    emit_set_end(set_list);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints:
+ * true - set is subset of other set
+ * false - in other case
+ *
+ * @param[in] set_list
+ * @param[in] set_number_1
+ * @param[in] set_number_2
+ * @return 0 - given set numbers are invalid, 1 - input is correct
+ */
+static int is_subset(Set_list *set_list, int set_number_1, int set_number_2)
+{
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Set *first_set = &set_list->sets[set_number_1];
+    Set *second_set = &set_list->sets[set_number_2];
+
+    /// Subset can't be greater than superset or equal to it, its signature can't have extra bits
+    if (first_set->cardinality >= second_set->cardinality || (first_set->signature & ~second_set->signature)){
+        emit_bool(0);
+        return 1;
+    }
+
+    emit_bool(!set_filter(set_list, first_set, second_set, 0, 0));
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints:
+ * true - set is subseteq of other set
+ * false - in other case
+ *
+ * @param[in] set_list
+ * @param[in] set_number_1
+ * @param[in] set_number_2
+ * @return 0 - given set numbers are invalid, 1 - input is correct
+ */
+static int is_subseteq(Set_list *set_list, int set_number_1, int set_number_2)
+{
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Set *first_set = &set_list->sets[set_number_1];
+    Set *second_set = &set_list->sets[set_number_2];
+
+    /// Subseteq can't be greater than superset, its signature can't have extra bits,
+    /// identical sets share arrays
+    if (first_set->cardinality > second_set->cardinality || (first_set->signature & ~second_set->signature)){
+        emit_bool(0);
+    }
+    else if (first_set->elements == second_set->elements){
+        emit_bool(1);
+    }
+    else {
+        emit_bool(!set_filter(set_list, first_set, second_set, 0, 0));
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints:
+ * true - set is empty
+ * false - not empty
+ *
+ * @param[in] set_list
+ * @param[in] set_number
+ * @return 0 - given set number is valid, 1 - input is correct
+ */
+static int is_set_empty(Set_list *set_list, int set_number)
+{
+    if (!check_set_existence(set_list, &set_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    if (set_list->sets[set_number].cardinality == 0){
+        emit_bool(1);
+    }
+    else {
+        emit_bool(0);
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+* Prints true - equal, false - not equal
+*
+* @param[in] set_list
+* @param[in] set_number_1
+* @param[in] set_number_2
+*/
+static int are_sets_equal(Set_list *set_list, int set_number_1, int set_number_2)
+{
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Set *first_set = &set_list->sets[set_number_1];
+    Set *second_set = &set_list->sets[set_number_2];
+
+    /// Identical sets share arrays, sets with different signatures or hashes differ,
+    /// sets of the same size are equal if one of them is subseteq of the other one
+    if (first_set->cardinality != second_set->cardinality || first_set->signature != second_set->signature ||
+        first_set->hash != second_set->hash){
+        emit_bool(0);
+    }
+    else if (first_set->elements == second_set->elements){
+        emit_bool(1);
+    }
+    else {
+        emit_bool(!set_filter(set_list, first_set, second_set, 0, 0));
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+* Function prints intersect of 2 sets
+*
+* @param[in] set_list
+* @param[in] set_number_1
+* @param[in] set_number_2
+*/
+static int intersect_of_sets(Set_list *set_list, int set_number_1, int set_number_2)
+{
+    if (!check_set_existence(set_list, &set_number_1) ||
+        !check_set_existence(set_list, &set_number_2)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Set *first_set = &set_list->sets[set_number_1];
+    Set *second_set = &set_list->sets[set_number_2];
+
+    /// Intersection is symmetric, smaller set probes the bigger one
+    emit_set_begin('S');
+    if (first_set->cardinality <= second_set->cardinality){
+        set_filter(set_list, first_set, second_set, 1, 1);
+    }
+    else {
+        set_filter(set_list, second_set, first_set, 1, 1);
+    }
+    emit_set_end(set_list);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Constructor for command plan
+ *
+ * @param[in] plan
+ */
+static void plan_ctor(Command_plan *plan)
+{
+    plan->size = 0;
+    plan->first = 0;
+    plan->second = 0;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints set given by bitset over universe
+ *
+ * @param[in] set_list
+ * @param[in] bitset
+ */
+static void print_bitset(Set_list *set_list, unsigned long long *bitset)
+{
+    int words = bitset_words(set_list);
+
+    emit_set_begin('S');
+    for (int w = 0; w < words; w++){
+        unsigned long long word = bitset[w];
+        while (word){
+            emit_element(set_list, w * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+    emit_set_end(set_list);
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function executes one command over two sets without fusing
+ *
+ * @param[in] set_list
+ * @param[in] command
+ * @param[in] set_number_1
+ * @param[in] set_number_2
+ * @return 0 - error, 1 - in other case
+ */
+static int run_set_command(Set_list *set_list, int command, int set_number_1, int set_number_2)
+{
+    switch (command){
+        case UNION:
+            return union_of_sets(set_list, set_number_1, set_number_2);
+        case INTERSECT:
+            return intersect_of_sets(set_list, set_number_1, set_number_2);
+        case MINUS:
+            return minus_of_sets(set_list, set_number_1, set_number_2);
+        case SUBSETEQ:
+            return is_subseteq(set_list, set_number_1, set_number_2);
+        case SUBSET:
+            return is_subset(set_list, set_number_1, set_number_2);
+        default:
+            return are_sets_equal(set_list, set_number_1, set_number_2);
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function executes planned commands. All of them share the same two sets,
+ * so their results are computed in one pass over bitsets of the sets and
+ * printed in original order.
+ *
+ * @param[in] plan
+ * @param[in] set_list
+ * @return 0 - error, 1 - in other case
+ */
+static int flush_plan(Command_plan *plan, Set_list *set_list)
+{
+    if (plan->size == 0){
+        return 1;
+    }
+
+    if (plan->size == 1){
+        plan->size = 0;
+        if (plan->swapped[0]){
+            return run_set_command(set_list, plan->commands[0], plan->second, plan->first);
+        }
+        return run_set_command(set_list, plan->commands[0], plan->first, plan->second);
+    }
+
+    int first = plan->first;
+    int second = plan->second;
+    check_set_existence(set_list, &first);
+    check_set_existence(set_list, &second);
+    unsigned long long *a = set_bitset(set_list, &set_list->sets[first]);
+    unsigned long long *b = set_bitset(set_list, &set_list->sets[second]);
+    int words = bitset_words(set_list);
+    if (a == NULL || b == NULL){
+        plan->size = 0;
+        return 0;
+    }
+
+    /// Results: A & B, A | B, A \ B, B \ A
+    unsigned long long *results[4] = {NULL, NULL, NULL, NULL};
+    for (int i = 0; i < plan->size; i++){
+        int result = -1;
+        if (plan->commands[i] == INTERSECT){
+            result = 0;
+        }
+        else if (plan->commands[i] == UNION){
+            result = 1;
+        }
+        else if (plan->commands[i] == MINUS){
+            result = plan->swapped[i] ? 3 : 2;
+        }
+
+        if (result >= 0 && results[result] == NULL){
+            results[result] = (unsigned long long *) malloc(sizeof(unsigned long long) * (words + 1));
+            if (results[result] == NULL){
+                fprintf(stderr, "Not enough memory!\n");
+                for (int j = 0; j < 4; j++){
+                    free(results[j]);
+                }
+                plan->size = 0;
+                return 0;
+            }
+        }
+    }
+
+    unsigned long long a_not_b = 0;
+    unsigned long long b_not_a = 0;
+    for (int w = 0; w < words; w++){
+        a_not_b |= a[w] & ~b[w];
+        b_not_a |= b[w] & ~a[w];
+        if (results[0] != NULL){
+            results[0][w] = a[w] & b[w];
+        }
+        if (results[1] != NULL){
+            results[1][w] = a[w] | b[w];
+        }
+        if (results[2] != NULL){
+            results[2][w] = a[w] & ~b[w];
+        }
+        if (results[3] != NULL){
+            results[3][w] = b[w] & ~a[w];
+        }
+    }
+
+    for (int i = 0; i < plan->size; i++){
+        /// Elements of left operand missing in right one and vice versa
+        int left_extra = plan->swapped[i] ? b_not_a != 0 : a_not_b != 0;
+        int right_extra = plan->swapped[i] ? a_not_b != 0 : b_not_a != 0;
+
+        switch (plan->commands[i]){
+            case INTERSECT:
+                print_bitset(set_list, results[0]);
+                break;
+            case UNION:
+                print_bitset(set_list, results[1]);
+                break;
+            case MINUS:
+                print_bitset(set_list, results[plan->swapped[i] ? 3 : 2]);
+                break;
+            case SUBSETEQ:
+                emit_bool(!left_extra);
+                break;
+            case SUBSET:
+                emit_bool(!left_extra && right_extra);
+                break;
+            default:
+                emit_bool(!left_extra && !right_extra);
+        }
+    }
+
+    for (int i = 0; i < 4; i++){
+        free(results[i]);
+    }
+    plan->size = 0;
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function plans command over two sets. Consecutive commands over the same
+ * sets are executed together when another command comes.
+ *
+ * @param[in] plan
+ * @param[in] set_list
+ * @param[in] command
+ * @param[in] set_number_1
+ * @param[in] set_number_2
+ * @return 0 - error, 1 - in other case
+ */
+static int plan_command(Command_plan *plan, Set_list *set_list, int command, int set_number_1, int set_number_2)
+{
+    int first = set_number_1;
+    int second = set_number_2;
+    if (!check_set_existence(set_list, &first) ||
+        !check_set_existence(set_list, &second)){
+        flush_plan(plan, set_list);
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    int same = (plan->first == set_number_1) && (plan->second == set_number_2);
+    int swapped = (plan->first == set_number_2) && (plan->second == set_number_1);
+    if ((plan->size > 0) && !same && !swapped){
+        if (!flush_plan(plan, set_list)){
+            return 0;
+        }
+    }
+
+    if (plan->size == 0){
+        plan->first = set_number_1;
+        plan->second = set_number_2;
+        swapped = 0;
+    }
+    plan->commands[plan->size] = command;
+    plan->swapped[plan->size] = swapped && !same;
+    plan->size++;
+
+    if (plan->size == MAX_PLANNED_COMMANDS){
+        return flush_plan(plan, set_list);
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function marks elements reachable by one or more steps of relation
+ * from sources. Visited elements are kept in bitset, frontier in queue.
+ *
+ * @param[in] relation
+ * @param[in] sources - indexes of elements in universe
+ * @param[in] number_of_sources
+ * @param[in] visited - zeroed bitset over universe, reachable elements on return
+ * @param[in] target - search stops when target is reached, -1 - search whole relation
+ * @return 1 - target was reached, 0 - in other case, -1 - not enough memory
+ */
+static int relation_reach(Relation *relation, int *sources, int number_of_sources,
+                          unsigned long long *visited, int target)
+{
+    int *queue = (int *) malloc(sizeof(int) * (relation->number_of_pairs + 1));
+    if (queue == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return -1;
+    }
+
+    int head = 0;
+    int tail = 0;
+    int reached = 0;
+
+    /// Queue of elements reached for the first time, each element enters it once
+    for (int i = 0; i < number_of_sources && !reached; i++){
+        int source = sources[i];
+        for (int j = relation->row_offsets[source]; j < relation->row_offsets[source + 1]; j++){
+            int next = relation->columns[j];
+            if (!(visited[next / 64] & (1ULL << (next % 64)))){
+                visited[next / 64] |= 1ULL << (next % 64);
+                queue[tail++] = next;
+                if (next == target){
+                    reached = 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    while (head < tail && !reached){
+        int element = queue[head++];
+        for (int j = relation->row_offsets[element]; j < relation->row_offsets[element + 1]; j++){
+            int next = relation->columns[j];
+            if (!(visited[next / 64] & (1ULL << (next % 64)))){
+                visited[next / 64] |= 1ULL << (next % 64);
+                queue[tail++] = next;
+                if (next == target){
+                    reached = 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    free(queue);
+
+    return reached;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints:
+ * true - element second is reachable from element first by one or more steps of relation
+ * false - in other case
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number
+ * @param[in] first
+ * @param[in] second
+ * @return 0 - error, 1 - in other case
+ */
+static int is_reachable(Relation_list *relation_list, Set_list *set_list, int relation_number, char *first, char *second)
+{
+    if (!check_relation_existence(relation_list, &relation_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    int source = universe_index(set_list, first);
+    int target = universe_index(set_list, second);
+    if (source < 0 || target < 0){
+        fprintf(stderr, "Error: Element %s isn't in universe\n", source < 0 ? first : second);
+        return 0;
+    }
+
+    unsigned long long *visited = (unsigned long long *) calloc(bitset_words(set_list) + 1, sizeof(unsigned long long));
+    if (visited == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+
+    int reached = relation_reach(&relation_list->relations[relation_number], &source, 1, visited, target);
+    free(visited);
+    if (reached < 0){
+        return 0;
+    }
+
+    emit_bool(reached);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints set of elements reachable from set by one or more steps of relation
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number
+ * @param[in] set_number
+ * @return 0 - error, 1 - in other case
+ */
+static int reachable_set(Relation_list *relation_list, Set_list *set_list, int relation_number, int set_number)
+{
+    if (!check_relation_existence(relation_list, &relation_number) ||
+        !check_set_existence(set_list, &set_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Set *set = &set_list->sets[set_number];
+    int *sources = (int *) malloc(sizeof(int) * (set->cardinality + 1));
+    unsigned long long *visited = (unsigned long long *) calloc(bitset_words(set_list) + 1, sizeof(unsigned long long));
+    if (sources == NULL || visited == NULL){
+        free(sources);
+        free(visited);
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+
+    for (int i = 0; i < set->cardinality; i++){
+        sources[i] = universe_index(set_list, set->elements[i]);
+    }
+
+    int reached = relation_reach(&relation_list->relations[relation_number], sources, set->cardinality, visited, -1);
+    if (reached >= 0){
+        print_bitset(set_list, visited);
+    }
+
+    free(sources);
+    free(visited);
+
+    return reached >= 0;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function finds strongly connected components of relation by iterative
+ * Tarjan's algorithm, so deep relations can't overflow the stack.
+ * Components are numbered in order of their smallest element.
+ *
+ * @param[in] relation
+ * @param[in] size_of_universe
+ * @param[out] component - component of every element of universe, -1 for elements outside relation
+ * @return number of components, -1 - not enough memory
+ */
+static int find_components(Relation *relation, int size_of_universe, int *component)
+{
+    int *order = (int *) malloc(sizeof(int) * (5 * size_of_universe + 1));
+    if (order == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return -1;
+    }
+    int *lowlink = order + size_of_universe;
+    int *stack = lowlink + size_of_universe;
+    int *calls = stack + size_of_universe;
+    int *edges = calls + size_of_universe;
+
+    for (int i = 0; i < size_of_universe; i++){
+        order[i] = -1;
+        component[i] = -1;
+    }
+
+    int counter = 0;
+    int stack_size = 0;
+    int number_of_components = 0;
+
+    for (int root = 0; root < size_of_universe; root++){
+        int has_pairs = (relation->row_offsets[root + 1] > relation->row_offsets[root]) ||
+                        (relation->column_offsets[root + 1] > relation->column_offsets[root]);
+        if (order[root] >= 0 || !has_pairs){
+            continue;
+        }
+
+        /// Explicit call stack of elements with position of next edge
+        int depth = 0;
+        calls[depth] = root;
+        edges[depth] = relation->row_offsets[root];
+        order[root] = lowlink[root] = counter++;
+        stack[stack_size++] = root;
+
+        while (depth >= 0){
+            int element = calls[depth];
+
+            if (edges[depth] < relation->row_offsets[element + 1]){
+                int next = relation->columns[edges[depth]++];
+                if (order[next] < 0){
+                    depth++;
+                    calls[depth] = next;
+                    edges[depth] = relation->row_offsets[next];
+                    order[next] = lowlink[next] = counter++;
+                    stack[stack_size++] = next;
+                }
+                else if (component[next] < 0 && order[next] < lowlink[element]){
+                    lowlink[element] = order[next];
+                }
+                continue;
+            }
+
+            if (lowlink[element] == order[element]){
+                int member;
+                do {
+                    member = stack[--stack_size];
+                    component[member] = number_of_components;
+                } while (member != element);
+                number_of_components++;
+            }
+
+            depth--;
+            if (depth >= 0 && lowlink[element] < lowlink[calls[depth]]){
+                lowlink[calls[depth]] = lowlink[element];
+            }
+        }
+    }
+
+    /// Renumber components by their smallest element
+    for (int i = 0; i < number_of_components; i++){
+        order[i] = -1;
+    }
+    int renumbered = 0;
+    for (int i = 0; i < size_of_universe; i++){
+        if (component[i] >= 0){
+            if (order[component[i]] < 0){
+                order[component[i]] = renumbered++;
+            }
+            component[i] = order[component[i]];
+        }
+    }
+
+    free(order);
+
+    return number_of_components;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints strongly connected components of relation as (a b c) (d) ...
+ * or condensation of relation, which is relation between smallest elements
+ * of components
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number
+ * @param[in] condensation 0 - print components, 1 - print condensation
+ * @return 0 - error, 1 - in other case
+ */
+static int relation_components(Relation_list *relation_list, Set_list *set_list, int relation_number, int condensation)
+{
+    if (!check_relation_existence(relation_list, &relation_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    Relation *relation = &relation_list->relations[relation_number];
+    int size_of_universe = set_list->sets[0].cardinality;
+    char **elements = set_list->sets[0].elements;
+
+    int *component = (int *) malloc(sizeof(int) * (2 * size_of_universe + 1));
+    if (component == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+    int *representative = component + size_of_universe;
+
+    int number_of_components = find_components(relation, size_of_universe, component);
+    if (number_of_components < 0){
+        free(component);
+        return 0;
+    }
+
+    if (!condensation){
+        /// Elements are bucketed by component by counting sort, so every bucket stays sorted
+        int *members = (int *) malloc(sizeof(int) * (size_of_universe + number_of_components + 2));
+        if (members == NULL){
+            free(component);
+            fprintf(stderr, "Not enough memory!\n");
+            return 0;
+        }
+        int *offsets = members + size_of_universe;
+        memset(offsets, 0, sizeof(int) * (number_of_components + 2));
+        for (int i = 0; i < size_of_universe; i++){
+            if (component[i] >= 0){
+                offsets[component[i] + 2]++;
+            }
+        }
+        for (int c = 0; c < number_of_components; c++){
+            offsets[c + 2] += offsets[c + 1];
+        }
+        for (int i = 0; i < size_of_universe; i++){
+            if (component[i] >= 0){
+                members[offsets[component[i] + 1]++] = i;
+            }
+        }
+
+        for (int c = 0; c < number_of_components; c++){
+            emit_text(c ? " (%s" : "(%s", elements[members[offsets[c]]]);
+            for (int i = offsets[c] + 1; i < offsets[c + 1]; i++){
+                emit_text(" %s", elements[members[i]]);
+            }
+            emit_text(")");
+        }
+        emit_text("\n");
+        free(members);
+        free(component);
+        return 1;
+    }
+
+    for (int i = size_of_universe - 1; i >= 0; i--){
+        if (component[i] >= 0){
+            representative[component[i]] = i;
+        }
+    }
+
+    unsigned long long *keys = (unsigned long long *) malloc(sizeof(unsigned long long) * (relation->number_of_pairs + 1));
+    if (keys == NULL){
+        free(component);
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+
+    int number_of_keys = 0;
+    for (int i = 0; i < size_of_universe; i++){
+        for (int j = relation->row_offsets[i]; j < relation->row_offsets[i + 1]; j++){
+            unsigned long long first = component[i];
+            unsigned long long second = component[relation->columns[j]];
+            if (first != second){
+                keys[number_of_keys++] = (first << 32) | second;
+            }
+        }
+    }
+    qsort(keys, number_of_keys, sizeof(unsigned long long), key_comparator);
+
+    emit_relation_begin();
+    for (int i = 0; i < number_of_keys; i++){
+        if (i > 0 && keys[i] == keys[i - 1]){
+            continue;
+        }
+        emit_pair(set_list, representative[keys[i] >> 32], representative[keys[i] & 0xFFFFFFFFULL]);
+    }
+    emit_relation_end();
+
+    free(keys);
+    free(component);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function finds index of element in universe, missing element is reported
+ *
+ * @param[in] set_list
+ * @param[in] element - element to find
+ * @return index of element, -1 - element isn't in universe
+ */
+static int element_index(Set_list *set_list, char *element)
+{
+    int index = universe_index(set_list, element);
+    if (index < 0){
+        fprintf(error_output(), "Error: Element %s isn't in universe\n", element);
+    }
+
+    return index;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function finds element in universe
+ *
+ * @param[in] set_list
+ * @param[in] element - element to find
+ * @return name of element stored in string pool, NULL - element isn't in universe
+ */
+static char *universe_element(Set_list *set_list, char *element)
+{
+    int index = element_index(set_list, element);
+    if (index < 0){
+        return NULL;
+    }
+
+    return set_list->sets[0].elements[index];
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function splits next token from line, token is terminated in place
+ *
+ * @param[in] cursor - position in line, moved behind token
+ * @return token, NULL - there isn't another token
+ */
+static char *next_token(char **cursor)
+{
+    char *start = *cursor;
+    while (isblank(*start)){
+        start++;
+    }
+    if (*start == '\0'){
+        *cursor = start;
+        return NULL;
+    }
+
+    char *end = start;
+    while ((*end != '\0') && !isblank(*end)){
+        end++;
+    }
+    if (*end != '\0'){
+        *end = '\0';
+        end++;
+    }
+    *cursor = end;
+
+    return start;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function classifies block of SCAN_BLOCK bytes, bit i of each mask
+ * belongs to byte i of block
+ *
+ * @param[in] block
+ * @param[out] blanks - spaces and tabs
+ * @param[out] closing - closing parentheses
+ * @param[out] letters - letters of english alphabet
+ */
+static void classify_block(const char *block, unsigned *blanks, unsigned *closing, unsigned *letters)
+{
+#if defined(__AVX2__)
+    __m256i bytes = _mm256_loadu_si256((const __m256i *) block);
+    __m256i lower = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+    __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')),
+                                    _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t')));
+    __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    *blanks = (unsigned) _mm256_movemask_epi8(blank);
+    *closing = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(')')));
+    *letters = (unsigned) _mm256_movemask_epi8(letter);
+#elif defined(__SSE2__)
+    __m128i bytes = _mm_loadu_si128((const __m128i *) block);
+    __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+    __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')),
+                                 _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t')));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                   _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    *blanks = (unsigned) _mm_movemask_epi8(blank);
+    *closing = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(')')));
+    *letters = (unsigned) _mm_movemask_epi8(letter);
+#else
+    *blanks = 0;
+    *closing = 0;
+    *letters = 0;
+    for (int i = 0; i < SCAN_BLOCK; i++){
+        char lower = (char) (block[i] | 0x20);
+        *blanks |= (unsigned) ((block[i] == ' ') || (block[i] == '\t')) << i;
+        *closing |= (unsigned) (block[i] == ')') << i;
+        *letters |= (unsigned) ((lower >= 'a') && (lower <= 'z')) << i;
+    }
+#endif
+}
+
+/// ======================================================================= ///
+
+/**
+ * Constructor for scan of line, bitmaps of blanks and closing parentheses
+ * are filled block by block
+ *
+ * @param[in] scan
+ * @param[in] line
+ * @param[in] length - length of line
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int scan_line(Line_scan *scan, const char *line, size_t length)
+{
+    size_t words = length / 64 + 1;
+    scan->blanks = (unsigned long long *) calloc(words, sizeof(unsigned long long));
+    scan->closing = (unsigned long long *) calloc(words, sizeof(unsigned long long));
+    if (scan->blanks == NULL || scan->closing == NULL){
+        free(scan->blanks);
+        free(scan->closing);
+        fprintf(error_output(), "Not enough memory!\n");
+        return 0;
+    }
+    scan->length = length;
+    scan->alphabetic = 1;
+
+    size_t i = 0;
+    for (; i + SCAN_BLOCK <= length; i += SCAN_BLOCK){
+        unsigned blanks, closing, letters;
+        classify_block(line + i, &blanks, &closing, &letters);
+        scan->blanks[i / 64] |= (unsigned long long) blanks << (i % 64);
+        scan->closing[i / 64] |= (unsigned long long) closing << (i % 64);
+        if ((blanks | letters) != SCAN_MASK){
+            scan->alphabetic = 0;
+        }
+    }
+
+    /// Rest of line shorter than block
+    for (; i < length; i++){
+        if ((line[i] == ' ') || (line[i] == '\t')){
+            scan->blanks[i / 64] |= 1ULL << (i % 64);
+            continue;
+        }
+        if (line[i] == ')'){
+            scan->closing[i / 64] |= 1ULL << (i % 64);
+        }
+        if (!isalpha((unsigned char) line[i])){
+            scan->alphabetic = 0;
+        }
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function free resources for scan of line
+ *
+ * @param[in] scan
+ */
+static void free_line_scan(Line_scan *scan)
+{
+    free(scan->blanks);
+    free(scan->closing);
+    scan->blanks = NULL;
+    scan->closing = NULL;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function finds next blank (or next character which isn't blank) in scanned line
+ *
+ * @param[in] scan
+ * @param[in] position - first position to check
+ * @param[in] blank 1 - find blank, 0 - find character which isn't blank
+ * @param[in] closing 1 - closing parenthesis is found as blank
+ * @return found position, length of line if there isn't any
+ */
+static size_t scan_find(Line_scan *scan, size_t position, int blank, int closing)
+{
+    for (size_t w = position / 64; w * 64 < scan->length; w++){
+        unsigned long long word = blank ? scan->blanks[w] : ~scan->blanks[w];
+        if (closing){
+            word |= scan->closing[w];
+        }
+        if (w == position / 64){
+            word &= ~0ULL << (position % 64);
+        }
+        if (word){
+            size_t found = w * 64 + __builtin_ctzll(word);
+            return found < scan->length ? found : scan->length;
+        }
+    }
+
+    return scan->length;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function parses row number given as argument of command
+ *
+ * @param[in] token
+ * @return row number, 0 - token isn't positive number
+ */
+static int parse_row(char *token)
+{
+    char *end;
+    long row = strtol(token, &end, 10);
+    if ((*end != '\0') || (row <= 0) || (row > MAX_LINES)){
+        return 0;
+    }
+
+    return (int) row;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function appends row to posting list, rows are stored as varint deltas
+ *
+ * @param[in] list
+ * @param[in] row - row greater than last row in list
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int posting_append(Posting_list *list, int row)
+{
+    if (list->capacity - list->length < 5){
+        int capacity = list->capacity ? list->capacity * 2 : 8;
+        unsigned char *temp = (unsigned char *) realloc(list->data, capacity);
+        if (temp == NULL){
+            fprintf(stderr, "Not enough memory!\n");
+            return 0;
+        }
+        list->data = temp;
+        list->capacity = capacity;
+    }
+
+    unsigned int delta = (unsigned int) (row - list->last);
+    while (delta >= 0x80){
+        list->data[list->length++] = (unsigned char) (delta | 0x80);
+        delta >>= 7;
+    }
+    list->data[list->length++] = (unsigned char) delta;
+    list->last = row;
+    list->count++;
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function decodes next row of posting list
+ *
+ * @param[in] list
+ * @param[in] cursor - position in list, 0 at the beginning
+ * @param[in] row - previous row, 0 at the beginning, next row on return
+ * @return 0 - end of list, 1 - in other case
+ */
+static int posting_next(Posting_list *list, int *cursor, int *row)
+{
+    if (*cursor >= list->length){
+        return 0;
+    }
+
+    unsigned int delta = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+        byte = list->data[(*cursor)++];
+        delta |= (unsigned int) (byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    *row += (int) delta;
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function inserts row to posting list or removes it, list is encoded again
+ *
+ * @param[in] list
+ * @param[in] row
+ * @param[in] remove 0 - insert row, 1 - remove row
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int posting_update(Posting_list *list, int row, int remove)
+{
+    int rows[list->count + 1];
+    int count = 0;
+    int cursor = 0;
+    int value = 0;
+    int inserted = remove;
+
+    while (posting_next(list, &cursor, &value)){
+        if (!inserted && value > row){
+            rows[count++] = row;
+            inserted = 1;
+        }
+        if (!(remove && value == row)){
+            rows[count++] = value;
+        }
+    }
+    if (!inserted){
+        rows[count++] = row;
+    }
+
+    list->length = 0;
+    list->count = 0;
+    list->last = 0;
+    for (int i = 0; i < count; i++){
+        if (!posting_append(list, rows[i])){
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function builds inverted index, which maps every element of universe
+ * to rows of sets containing it (universe isn't included)
+ *
+ * @param[in] set_list
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int build_inverted_index(Set_list *set_list)
+{
+    int size_of_universe = set_list->sets[0].cardinality;
+    Inverted_index *index = &set_list->index;
+
+    index->lists = (Posting_list *) calloc(size_of_universe + 1, sizeof(Posting_list));
+    if (index->lists == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+    index->size = size_of_universe;
+
+    for (int i = 1; i < set_list->size; i++){
+        Set_cursor cursor;
+        set_cursor_ctor(&cursor, &set_list->sets[i]);
+        int id;
+        while (set_cursor_next(&cursor, &id)){
+            if (!posting_append(&index->lists[id], set_list->sets[i].position)){
+                return 0;
+            }
+        }
+    }
+    index->built = 1;
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints rows of sets containing all given elements (or any of them).
+ * Posting lists are intersected starting with the shortest one.
+ *
+ * @param[in] set_list
+ * @param[in] cursor - elements separated by blanks
+ * @param[in] any 0 - all elements, 1 - any element
+ * @return 0 - error, 1 - in other case
+ */
+static int sets_containing(Set_list *set_list, char *cursor, int any)
+{
+    Inverted_index *index = &set_list->index;
+
+    /// Lists are allocated by number of arguments, universe can be too large for stack
+    int number_of_arguments = 0;
+    for (char *c = cursor; *c != '\0'; c++){
+        if (!isblank(*c) && (c == cursor || isblank(c[-1]))){
+            number_of_arguments++;
+        }
+    }
+    if (number_of_arguments == 0){
+        fprintf(stderr, "Too few arguments!\n");
+        return 0;
+    }
+    if (number_of_arguments > index->size){
+        fprintf(stderr, "Too many arguments!\n");
+        return 0;
+    }
+
+    Posting_list **lists = (Posting_list **) malloc(sizeof(Posting_list *) * number_of_arguments);
+    if (lists == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+
+    int number_of_lists = 0;
+    char *element;
+    while ((element = next_token(&cursor)) != NULL){
+        int id = universe_index(set_list, element);
+        if (id < 0){
+            fprintf(stderr, "Error: Element %s isn't in universe\n", element);
+            free(lists);
+            return 0;
+        }
+        lists[number_of_lists++] = &index->lists[id];
+    }
+
+    int printed = 0;
+    int row = 0;
+    int position = 0;
+
+    if (any){
+        char found[MAX_LINES + 1];
+        memset(found, 0, sizeof(found));
+        for (int i = 0; i < number_of_lists; i++){
+            position = 0;
+            row = 0;
+            while (posting_next(lists[i], &position, &row)){
+                found[row] = 1;
+            }
+        }
+        for (int i = 1; i <= MAX_LINES; i++){
+            if (found[i]){
+                emit_text(printed++ ? " %d" : "%d", i);
+            }
+        }
+        emit_text("\n");
+        free(lists);
+        return 1;
+    }
+
+    int shortest = 0;
+    for (int i = 1; i < number_of_lists; i++){
+        if (lists[i]->count < lists[shortest]->count){
+            shortest = i;
+        }
+    }
+
+    /// Positions and last rows of other lists
+    int *positions = (int *) calloc(2 * number_of_lists, sizeof(int));
+    if (positions == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        free(lists);
+        return 0;
+    }
+    int *rows = positions + number_of_lists;
+
+    while (posting_next(lists[shortest], &position, &row)){
+        int in_all = 1;
+        for (int i = 0; i < number_of_lists && in_all; i++){
+            if (i == shortest){
+                continue;
+            }
+            while (rows[i] < row && posting_next(lists[i], &positions[i], &rows[i])){
+            }
+            in_all = rows[i] == row;
+        }
+        if (in_all){
+            emit_text(printed++ ? " %d" : "%d", row);
+        }
+    }
+    emit_text("\n");
+    free(positions);
+    free(lists);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function restores min-heap of keys after key on position was increased
+ *
+ * @param[in] heap
+ * @param[in] size
+ * @param[in] position
+ */
+static void key_heap_down(unsigned long long *heap, int size, int position)
+{
+    while (2 * position + 1 < size){
+        int child = 2 * position + 1;
+        if (child + 1 < size && heap[child + 1] < heap[child]){
+            child++;
+        }
+        if (heap[position] <= heap[child]){
+            break;
+        }
+        unsigned long long key = heap[position];
+        heap[position] = heap[child];
+        heap[child] = key;
+        position = child;
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints union of sets. Sorted elements of sets are merged by heap
+ * of keys (element << 32 | set), unless it is cheaper to accumulate sets
+ * into one bitset, i.e. when sets are dense or there are many elements.
+ *
+ * @param[in] set_list
+ * @param[in] sets - indexes of sets in list
+ * @param[in] number_of_sets
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int union_of_all(Set_list *set_list, int *sets, int number_of_sets)
+{
+    int words = bitset_words(set_list);
+    long elements = 0;
+    long bitsets = 0;
+    for (int i = 0; i < number_of_sets; i++){
+        elements += set_list->sets[sets[i]].cardinality;
+        bitsets += set_list->sets[sets[i]].representation == SET_BITSET;
+    }
+    long merge_cost = elements * (long) (log2(number_of_sets) + 1);
+    long accumulate_cost = words * (bitsets + 1) + elements;
+
+    if (bitsets > 0 || accumulate_cost < merge_cost){
+        unsigned long long *result = (unsigned long long *) calloc(words + 1, sizeof(unsigned long long));
+        if (result == NULL){
+            fprintf(stderr, "Not enough memory!\n");
+            return 0;
+        }
+        for (int i = 0; i < number_of_sets; i++){
+            Set *set = &set_list->sets[sets[i]];
+            if (set->representation == SET_BITSET){
+                for (int w = 0; w < words; w++){
+                    result[w] |= set->bitset[w];
+                }
+                continue;
+            }
+            Set_cursor cursor;
+            set_cursor_ctor(&cursor, set);
+            int id;
+            while (set_cursor_next(&cursor, &id)){
+                result[id / 64] |= 1ULL << (id % 64);
+            }
+        }
+        print_bitset(set_list, result);
+        free(result);
+        return 1;
+    }
+
+    Set_cursor cursors[number_of_sets];
+    unsigned long long heap[number_of_sets];
+    int size = 0;
+    for (int i = 0; i < number_of_sets; i++){
+        set_cursor_ctor(&cursors[i], &set_list->sets[sets[i]]);
+        int id;
+        if (set_cursor_next(&cursors[i], &id)){
+            heap[size++] = ((unsigned long long) id << 32) | i;
+        }
+    }
+    for (int i = size / 2 - 1; i >= 0; i--){
+        key_heap_down(heap, size, i);
+    }
+
+    emit_set_begin('S');
+    int last = -1;
+    while (size > 0){
+        int id = (int) (heap[0] >> 32);
+        int i = (int) (heap[0] & 0xFFFFFFFFULL);
+        if (id != last){
+            emit_element(set_list, id);
+            last = id;
+        }
+        if (set_cursor_next(&cursors[i], &id)){
+            heap[0] = ((unsigned long long) id << 32) | i;
+        }
+        else {
+            heap[0] = heap[--size];
+        }
+        key_heap_down(heap, size, 0);
+    }
+    emit_set_end(set_list);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints intersection of sets. Sets are visited from the smallest one,
+ * which gives candidates, and the computation stops as soon as no candidate
+ * is left. Dense sets are intersected word by word in one bitset.
+ *
+ * @param[in] set_list
+ * @param[in] sets - indexes of sets in list
+ * @param[in] number_of_sets
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int intersect_of_all(Set_list *set_list, int *sets, int number_of_sets)
+{
+    /// Keys (cardinality << 32 | set) order sets from the smallest one
+    unsigned long long order[number_of_sets];
+    for (int i = 0; i < number_of_sets; i++){
+        order[i] = ((unsigned long long) set_list->sets[sets[i]].cardinality << 32) | (unsigned) sets[i];
+    }
+    qsort(order, number_of_sets, sizeof(unsigned long long), key_comparator);
+    Set *smallest = &set_list->sets[order[0] & 0xFFFFFFFFULL];
+
+    if (smallest->representation == SET_BITSET){
+        /// Other sets are at least as big as the smallest one, so one bitset is accumulated
+        int words = bitset_words(set_list);
+        unsigned long long *result = (unsigned long long *) malloc(sizeof(unsigned long long) * (words + 1));
+        if (result == NULL){
+            fprintf(stderr, "Not enough memory!\n");
+            return 0;
+        }
+        memcpy(result, smallest->bitset, sizeof(unsigned long long) * words);
+
+        int empty = 0;
+        for (int i = 1; i < number_of_sets && !empty; i++){
+            Set *set = &set_list->sets[order[i] & 0xFFFFFFFFULL];
+            unsigned long long any = 0;
+            if (set->representation == SET_BITSET){
+                for (int w = 0; w < words; w++){
+                    result[w] &= set->bitset[w];
+                    any |= result[w];
+                }
+            }
+            else {
+                int position = 0;
+                for (int w = 0; w < words; w++){
+                    unsigned long long word = result[w];
+                    while (word){
+                        int id = w * 64 + __builtin_ctzll(word);
+                        if (!set_probe(set, &position, id)){
+                            result[w] &= ~(1ULL << (id % 64));
+                        }
+                        word &= word - 1;
+                    }
+                    any |= result[w];
+                }
+            }
+            empty = (any == 0);
+        }
+        print_bitset(set_list, result);
+        free(result);
+        return 1;
+    }
+
+    int *candidates = (int *) malloc(sizeof(int) * (smallest->cardinality + 1));
+    if (candidates == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+    int size = 0;
+    Set_cursor cursor;
+    set_cursor_ctor(&cursor, smallest);
+    while (set_cursor_next(&cursor, &candidates[size])){
+        size++;
+    }
+
+    for (int i = 1; i < number_of_sets && size > 0; i++){
+        Set *set = &set_list->sets[order[i] & 0xFFFFFFFFULL];
+        int position = 0;
+        int kept = 0;
+        for (int j = 0; j < size; j++){
+            if (set_probe(set, &position, candidates[j])){
+                candidates[kept++] = candidates[j];
+            }
+        }
+        size = kept;
+    }
+
+    emit_set_begin('S');
+    for (int i = 0; i < size; i++){
+        emit_element(set_list, candidates[i]);
+    }
+    emit_set_end(set_list);
+    free(candidates);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function prints union or intersection of all given sets. Sets are given
+ * by row numbers or ranges of rows, e.g. "2 5-40 42".
+ *
+ * @param[in] set_list
+ * @param[in] cursor - arguments of command
+ * @param[in] intersection 0 - union, 1 - intersection
+ * @return 0 - error, 1 - in other case
+ */
+static int sets_aggregate(Set_list *set_list, char *cursor, int intersection)
+{
+    char selected[MAX_LINES + 1];
+    memset(selected, 0, sizeof(selected));
+    int number_of_rows = 0;
+    char *token;
+
+    while ((token = next_token(&cursor)) != NULL){
+        char *dash = strchr(token, '-');
+        if (dash != NULL){
+            *dash = '\0';
+        }
+        int from = parse_row(token);
+        int to = dash != NULL ? parse_row(dash + 1) : from;
+        if (dash != NULL){
+            *dash = '-';
+        }
+        if (!from || !to || to < from){
+            fprintf(stderr, "Wrong argument %s!\n", token);
+            return 0;
+        }
+        for (int row = from; row <= to; row++){
+            number_of_rows += !selected[row];
+            selected[row] = 1;
+        }
+    }
+
+    if (number_of_rows == 0){
+        fprintf(stderr, "Too few arguments!\n");
+        return 0;
+    }
+
+    int sets[number_of_rows];
+    int number_of_sets = 0;
+    for (int row = 1; row <= MAX_LINES; row++){
+        if (!selected[row]){
+            continue;
+        }
+        int set_number = row;
+        if (!check_set_existence(set_list, &set_number)){
+            fprintf(stderr, "Can't step on nonexistent row!\n");
+            return 0;
+        }
+        sets[number_of_sets++] = set_number;
+    }
+
+    if (intersection){
+        return intersect_of_all(set_list, sets, number_of_sets);
+    }
+    return union_of_all(set_list, sets, number_of_sets);
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function finds position of element in sorted elements of set
+ *
+ * @param[in] set
+ * @param[in] element
+ * @return position of element or position where element belongs
+ */
+static int set_lower_bound(Set *set, char *element)
+{
+    int low = 0;
+    int high = set->cardinality;
+
+    while (low < high){
+        int middle = low + (high - low) / 2;
+        if (strcmp(set->elements[middle], element) < 0){
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function inserts element to set or erases it from set and prints the set.
+ * Sorted elements, sketch and representation of set are updated in place.
+ * Set sharing arrays with identical sets gets its own copy first.
+ *
+ * @param[in] set_list
+ * @param[in] set_number
+ * @param[in] element
+ * @param[in] erase 0 - insert element, 1 - erase element
+ * @return 0 - error, 1 - in other case
+ */
+static int modify_set(Set_list *set_list, int set_number, char *element, int erase)
+{
+    if (!check_set_existence(set_list, &set_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+    if (set_number == 0){
+        fprintf(stderr, "Can't modify universe!\n");
+        return 0;
+    }
+
+    int index = universe_index(set_list, element);
+    if (index < 0){
+        fprintf(stderr, "Error: Element %s isn't in universe\n", element);
+        return 0;
+    }
+    char *name = set_list->sets[0].elements[index];
+
+    Set *set = &set_list->sets[set_number];
+    int position = set_lower_bound(set, name);
+    int stored = (position < set->cardinality) && (set->elements[position] == name);
+
+    if (stored == erase && !detach_set(set_list, set)){
+        return 0;
+    }
+
+    if (!erase){
+        if (stored){
+            fprintf(stderr, "Element was already stored!\n");
+            return 0;
+        }
+        if (!add_element_to_set(set, name)){
+            return 0;
+        }
+        memmove(set->elements + position + 1, set->elements + position,
+                sizeof(char *) * (set->cardinality - 1 - position));
+        set->elements[position] = name;
+        sketch_add(set->sketch, name);
+    }
+    else {
+        if (!stored){
+            fprintf(stderr, "Element %s isn't in set!\n", name);
+            return 0;
+        }
+        memmove(set->elements + position, set->elements + position + 1,
+                sizeof(char *) * (set->cardinality - 1 - position));
+        set->cardinality--;
+
+        /// Registers of sketch can't be decreased, so sketch is refilled
+        memset(set->sketch, 0, HLL_REGISTERS);
+        for (int i = 0; i < set->cardinality; i++){
+            sketch_add(set->sketch, set->elements[i]);
+        }
+    }
+
+    fingerprint_update(set, name, erase);
+    if (!update_representation(set_list, set, position, index, erase)){
+        return 0;
+    }
+    if (set_list->index.built && !posting_update(&set_list->index.lists[index], set->position, erase)){
+        return 0;
+    }
+
+    print_set(set_list, *set);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function adds pair to relation or deletes it from relation and prints the relation
+ *
+ * @param[in] relation_list
+ * @param[in] set_list
+ * @param[in] relation_number
+ * @param[in] first
+ * @param[in] second
+ * @param[in] delete 0 - add pair, 1 - delete pair
+ * @return 0 - error, 1 - in other case
+ */
+static int modify_relation(Relation_list *relation_list, Set_list *set_list, int relation_number,
+                           char *first, char *second, int delete)
+{
+    if (!check_relation_existence(relation_list, &relation_number)){
+        fprintf(stderr, "Can't step on nonexistent row!\n");
+        return 0;
+    }
+
+    int first_index = element_index(set_list, first);
+    int second_index = element_index(set_list, second);
+    if (first_index < 0 || second_index < 0){
+        return 0;
+    }
+
+    Relation *relation = &relation_list->relations[relation_number];
+    int stored = relation_contains(relation, first_index, second_index);
+
+    if (stored == delete && !detach_relation(relation, set_list)){
+        return 0;
+    }
+
+    /// Changes are kept as pending pairs, adjacency isn't rebuilt after every one of them
+    unsigned long long key = ((unsigned long long) first_index << 32) | (unsigned) second_index;
+    if (!delete){
+        if (stored){
+            fprintf(stderr, "Pair was already stored!\n");
+            return 0;
+        }
+        int slot = relation->number_of_pairs + relation->deleted;
+        if (!add_pair_to_relation(relation, first_index, second_index)){
+            return 0;
+        }
+        if (!set_pending(relation, key, slot)){
+            relation->number_of_pairs--;
+            return 0;
+        }
+        relation->hash += pair_hash(first_index, second_index);
+    }
+    else {
+        if (!stored){
+            fprintf(stderr, "Pair (%s %s) isn't in relation!\n", first, second);
+            return 0;
+        }
+
+        /// Pair was added after adjacency was built or it is found in adjacency
+        int position = pending_lower_bound(relation, key);
+        int in_adjacency = adjacency_find(relation, first_index, second_index);
+        int slot = (position < relation->number_of_pending && relation->pending[position].key == key) ?
+                   relation->pending[position].slot : relation->slots[in_adjacency];
+        if (in_adjacency >= 0){
+            if (!set_pending(relation, key, -1)){
+                return 0;
+            }
+        }
+        else {
+            memmove(relation->pending + position, relation->pending + position + 1,
+                    sizeof(Pending_pair) * (relation->number_of_pending - position - 1));
+            relation->number_of_pending--;
+        }
+
+        relation->first[slot] = -1;
+        relation->second[slot] = -1;
+        relation->number_of_pairs--;
+        relation->deleted++;
+        relation->hash -= pair_hash(first_index, second_index);
+    }
+
+    /// Adjacency is built again when changes outgrow square root of its size,
+    /// so the cost of a rebuild is spread over many changes
+    long long changes = relation->number_of_pending + relation->deleted;
+    if (changes * changes > (long long) set_list->sets[0].cardinality + relation->number_of_pairs &&
+        !merge_pending(relation, set_list)){
+        return 0;
+    }
+
+    print_relation(set_list, *relation);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function executes commands with elements as arguments:
+ * insert S x, erase S x, addpair R a b, delpair R a b and reach R a b
+ *
+ * @param[in] command
+ * @param[in] cursor - arguments of command
+ * @param[in] set_list
+ * @param[in] relation_list
+ * @return 0 - error, 1 - in other case
+ */
+static int run_element_command(int command, char *cursor, Set_list *set_list, Relation_list *relation_list)
+{
+    int number_of_elements = (command == INSERT || command == ERASE) ? 1 : 2;
+    char *row = next_token(&cursor);
+    char *elements[2] = {NULL, NULL};
+    for (int i = 0; i < number_of_elements; i++){
+        elements[i] = next_token(&cursor);
+    }
+
+    if (row == NULL || elements[number_of_elements - 1] == NULL){
+        fprintf(stderr, "Too few arguments!\n");
+        return 0;
+    }
+    if (next_token(&cursor) != NULL){
+        fprintf(stderr, "Too many arguments!\n");
+        return 0;
+    }
+    if (!parse_row(row)){
+        fprintf(stderr, "Wrong argument %s!\n", row);
+        return 0;
+    }
+
+    switch (command){
+        case INSERT:
+            return modify_set(set_list, parse_row(row), elements[0], 0);
+        case ERASE:
+            return modify_set(set_list, parse_row(row), elements[0], 1);
+        case ADDPAIR:
+            return modify_relation(relation_list, set_list, parse_row(row), elements[0], elements[1], 0);
+        case REACH:
+            return is_reachable(relation_list, set_list, parse_row(row), elements[0], elements[1]);
+        default:
+            return modify_relation(relation_list, set_list, parse_row(row), elements[0], elements[1], 1);
+    }
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function checks that element isn't identifier of command or keyword
+ *
+ * @param[in] element - element to check
+ * @return 0 - element is reserved word, 1 - in other case
+ */
+static int check_element_name(char *element)
+{
+    for (int i = 0; i < NUMBER_OF_COMMANDS; i++){
+        if (strcmp(element, command_names[i]) == 0){
+            fprintf(error_output(), "Set contains identifier of command!\n");
+            return 0;
+        }
+    }
+
+    if ((strcmp(element, "true") == 0) || (strcmp(element, "false") == 0)){
+        fprintf(error_output(), "Set contains identifier of command!\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function to check syntax of element
+ *
+ * @param[in] element - element to check
+ * @return 0 - element has wrong syntax, 1 - in other case
+ */
+static int check_element_syntax(char *element)
+{
+    for (int i = 0; element[i] != '\0'; i++){
+        if (!(isalpha(element[i]))){
+            fprintf(error_output(), "Wrong element syntax!\n");
+            return 0;
+        }
+    }
+
+    return check_element_name(element);
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function executes one command
+ *
+ * @param line - command line without leading 'C'
+ * @param plan - planned commands over two sets
+ * @param set_list
+ * @param relation_list
+ * @return 0 - command was wrong, 1 - in other case
+ */
+static int run_command(char *line, Command_plan *plan, Set_list *set_list, Relation_list *relation_list)
+{
+    if (strchr(line, '(') != NULL){
+        if (!flush_plan(plan, set_list)){
+            return 0;
+        }
+        return evaluate_expression(line, set_list);
+    }
+
+    char *cursor = line;
+    char *loaded_command = next_token(&cursor);
+    if (loaded_command == NULL){
+        fprintf(stderr, "Wrong syntax of input file!\n");
+        return 0;
+    }
+
+    int i;
+    for (i = 0; i < NUMBER_OF_COMMANDS; i++){
+        if (strcmp(loaded_command, command_names[i]) == 0){
+            break;
+        }
+    }
+
+    /// Changes of relations made by addpair and delpair are merged before adjacency is read
+    if ((i != ADDPAIR) && (i != DELPAIR) && !merge_relations(relation_list, set_list)){
+        return 0;
+    }
+
+    /// Arguments of modifying commands contain elements
+    if ((i == INSERT) || (i == ERASE) || (i == ADDPAIR) || (i == DELPAIR) || (i == REACH)){
+        if (!flush_plan(plan, set_list)){
+            return 0;
+        }
+        return run_element_command(i, cursor, set_list, relation_list);
+    }
+
+    if ((i == CONTAINS) || (i == CONTAINSALL) || (i == CONTAINSANY)){
+        if (!flush_plan(plan, set_list)){
+            return 0;
+        }
+        if (i == CONTAINS){
+            char *rest = cursor;
+            if ((next_token(&rest) != NULL) && (next_token(&rest) != NULL)){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+        }
+        return sets_containing(set_list, cursor, i == CONTAINSANY);
+    }
+
+    /// Arguments of aggregate commands can contain ranges of rows
+    if ((i == UNIONALL) || (i == INTERSECTALL)){
+        if (!flush_plan(plan, set_list)){
+            return 0;
+        }
+        return sets_aggregate(set_list, cursor, i == INTERSECTALL);
+    }
+
+    int args[3] = {0, 0, 0};
+    int number_of_args = 0;
+    char *token;
+    while ((token = next_token(&cursor)) != NULL){
+        if (number_of_args == 3){
+            fprintf(stderr, "Too many arguments!\n");
+            return 0;
+        }
+        args[number_of_args] = parse_row(token);
+        if (!args[number_of_args]){
+            fprintf(stderr, "Wrong argument %s!\n", token);
+            return 0;
+        }
+        number_of_args++;
+    }
+
+    int arg_1 = args[0];
+    int arg_2 = args[1];
+    int arg_3 = args[2];
+    if (!arg_1 && (i < NUMBER_OF_COMMANDS) && (i != SIMILARITY) && (i != LATTICE)){
+        fprintf(stderr, "Too few arguments!\n");
+        return 0;
+    }
+
+    /// Results of planned commands are printed before results of other commands
+    if ((i != UNION) && (i != INTERSECT) && (i != MINUS) &&
+        (i != SUBSETEQ) && (i != SUBSET) && (i != EQUALS)){
+        if (!flush_plan(plan, set_list)){
+            return 0;
+        }
+    }
+
+    switch (i){
+        case EMPTY:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!is_set_empty(set_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case CARD:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!set_card(set_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case COMPLEMENT:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!set_complement(set_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case UNION:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!plan_command(plan, set_list, UNION, arg_1, arg_2)){
+                return 0;
+            }
+            break;
+        }
+        case INTERSECT:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!plan_command(plan, set_list, INTERSECT, arg_1, arg_2)){
+                return 0;
+            }
+            break;
+        }
+        case MINUS:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!plan_command(plan, set_list, MINUS, arg_1, arg_2)){
+                return 0;
+            }
+            break;
+        }
+        case SUBSETEQ:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!plan_command(plan, set_list, SUBSETEQ, arg_1, arg_2)){
+                return 0;
+            }
+            break;
+        }
+        case SUBSET:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!plan_command(plan, set_list, SUBSET, arg_1, arg_2)){
+                return 0;
+            }
+            break;
+        }
+        case EQUALS:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!plan_command(plan, set_list, EQUALS, arg_1, arg_2)){
+                return 0;
+            }
+            break;
+        }
+        case REFLEXIVE:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!is_reflexive(relation_list, set_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case SYMMETRIC:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!is_symmetric(relation_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case ANTISYMMETRIC:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!is_antisymmetric(relation_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case TRANSITIVE:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!is_transitive(relation_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case FUNCTION:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!is_function(relation_list, set_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case DOMAIN:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!domain_or_codomain(relation_list, set_list, arg_1, 0)){
+                return 0;
+            }
+            break;
+        }
+        case CODOMAIN:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!domain_or_codomain(relation_list, set_list, arg_1, 1)){
+                return 0;
+            }
+            break;
+        }
+        case INJECTIVE:{
+            if (!arg_2 || !arg_3){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (!is_injective(relation_list, set_list, arg_1, arg_2, arg_3)){
+                return 0;
+            }
+            break;
+        }
+        case SURJECTIVE:{
+            if (!arg_2 || !arg_3){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (!is_surjective(relation_list, set_list, arg_1, arg_2, arg_3)){
+                return 0;
+            }
+            break;
+        }
+        case BIJECTIVE:{
+            if (!arg_2 || !arg_3){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (!is_bijective(relation_list, set_list, arg_1, arg_2, arg_3)){
+                return 0;
+            }
+            break;
+        }
+        case IMAGE:
+        case PREIMAGE:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!relation_image(relation_list, set_list, arg_1, arg_2, i == PREIMAGE)){
+                return 0;
+            }
+            break;
+        }
+        case REACHABLE:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!reachable_set(relation_list, set_list, arg_1, arg_2)){
+                return 0;
+            }
+            break;
+        }
+        case COMPOSE:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!relation_compose(relation_list, set_list, arg_1, arg_2)){
+                return 0;
+            }
+            break;
+        }
+        case RUNION:
+        case RINTERSECT:
+        case RMINUS:
+        case RSUBSETEQ:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!relation_algebra(relation_list, set_list, i, arg_1, arg_2)){
+                return 0;
+            }
+            break;
+        }
+        case INVERSE:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!relation_inverse(relation_list, set_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case SCC:
+        case CONDENSATION:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!relation_components(relation_list, set_list, arg_1, i == CONDENSATION)){
+                return 0;
+            }
+            break;
+        }
+        case PROFILE:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!relation_profile(relation_list, set_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case ACARD:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!approximate_card(set_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case AUNIONCARD:{
+            if (!arg_2){
+                fprintf(stderr, "Too few arguments!\n");
+                return 0;
+            }
+            if (arg_3){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!approximate_union_card(set_list, arg_1, arg_2)){
                 return 0;
             }
-            if (!are_sets_equal(set_list, arg_1, arg_2)){
+            break;
+        }
+        case SIMILARITY:{
+            if (arg_2){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!sets_similarity(set_list, arg_1)){
+                return 0;
+            }
+            break;
+        }
+        case LATTICE:{
+            if (arg_1){
+                fprintf(stderr, "Too many arguments!\n");
+                return 0;
+            }
+            if (!sets_lattice(set_list)){
                 return 0;
             }
             break;
         }
-        case REFLEXIVE:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!is_reflexive(relation_list, set_list, arg_1)){
-                return 0;
-            }
+        default:{
+            fprintf(stderr, "Command %s doesn't exist\n", loaded_command);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function reads rest of line from file into buffer, terminating null is appended
+ *
+ * @param[in] file
+ * @param[in] line - buffer for line
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int read_line(FILE *file, String_pool *line)
+{
+    ssize_t length = getline(&line->data, &line->capacity, file);
+    if (length < 0){
+        line->size = 0;
+        return pool_push(line, '\0');
+    }
+
+    if ((length > 0) && (line->data[length - 1] == '\n')){
+        length--;
+    }
+    line->data[length] = '\0';
+    line->size = length + 1;
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function reads command line from file and executes it
+ *
+ * @param file
+ * @param line - buffer for command line, it is reused by all commands
+ * @param plan - planned commands over two sets
+ * @param set_list
+ * @param relation_list
+ * @return 0 - command was wrong, 1 - in other case
+ */
+static int read_command(FILE *file, String_pool *line, Command_plan *plan, Set_list *set_list, Relation_list *relation_list)
+{
+    int c = fgetc(file);
+    if (c != ' '){
+        fprintf(stderr, "Wrong syntax of input file!\n");
+        return 0;
+    }
+
+    if (!read_line(file, line)){
+        return 0;
+    }
+
+    return run_command(line->data, plan, set_list, relation_list);
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function reads line of set or relation without leading 'U', 'S' or 'R'
+ *
+ * @param[in] file
+ * @param[in] line - buffer for line
+ * @return 0 - in case of error, 1 - in other case
+ */
+static int read_definition_line(FILE *file, String_pool *line)
+{
+    int c = fgetc(file);
+    if (c != ' ' && c != '\n'){
+        fprintf(stderr, "Wrong syntax of input file!\n");
+        return 0;
+    }
+
+    if (c == '\n'){
+        line->size = 0;
+        return pool_push(line, '\0');
+    }
+
+    return read_line(file, line);
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function adds all names stored in pool to set
+ *
+ * @param[in] set
+ * @param[in] pool - null terminated names
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int add_pool_to_set(Set *set, String_pool *pool)
+{
+    for (size_t offset = 0; offset < pool->size; offset += strlen(pool->data + offset) + 1){
+        if (!(add_element_to_set(set, pool->data + offset))){
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function sorts elements of new set, checks their uniqueness and builds
+ * hash, signature, sketch and representation of set
+ *
+ * @param[in] set_list
+ * @param[in] set
+ * @return 0 - in case of error, 1 - in other case
+ */
+static int prepare_set(Set_list *set_list, Set *set)
+{
+    /// Sort set elements in alphabetical order, empty set has no array of elements
+    if (set->cardinality > 1){
+        qsort(set->elements, set->cardinality, sizeof(char *), str_comparator);
+    }
+
+    for (int i = 1; i < set->cardinality; i++){
+        if (strcmp(set->elements[i - 1], set->elements[i]) == 0){
+            fprintf(error_output(), "Element was already stored!\n");
+            return 0;
+        }
+    }
+
+    set_fingerprint(set);
+
+    return build_sketch(set) && choose_representation(set_list, set);
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function parses elements of set from line.
+ * Names of universe are stored in string pool of set list, elements of
+ * other sets point to names of universe.
+ *
+ * @param[in] line - line without leading 'U' or 'S', it is split in place
+ * @param[in] set_list
+ * @param[in] set
+ * @return 0 - in case of error, 1 - in other case
+ */
+static int parse_set(char *line, Set_list *set_list, Set *set)
+{
+    int is_universe = (set_list->size == 0);
+
+    size_t length = strlen(line);
+    Line_scan scan;
+    if (!scan_line(&scan, line, length)){
+        return 0;
+    }
+
+    int success = 1;
+    size_t position = 0;
+    while (success && ((position = scan_find(&scan, position, 0, 0)) < length)){
+        size_t end = scan_find(&scan, position, 1, 0);
+        line[end] = '\0';
+        char *element = line + position;
+        position = end + 1;
+
+        /// Letters of elements were already checked by scanner
+        if (!(scan.alphabetic ? check_element_name(element) : check_element_syntax(element))){
+            success = 0;
+        }
+        else if (is_universe){
+            success = pool_append(&set_list->pool, element);
+        }
+        else {
+            char *name = universe_element(set_list, element);
+            success = (name != NULL) && add_element_to_set(set, name);
+        }
+    }
+    free_line_scan(&scan);
+
+    /// Pool of universe is complete, so its names won't move anymore
+    if (success && is_universe && !add_pool_to_set(set, &set_list->pool)){
+        return 0;
+    }
+
+    return success;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function parses pairs of relation from line
+ *
+ * @param[in] line - line without leading 'R', it is split in place
+ * @param[in] set_list
+ * @param[in] relation
+ * @return 0 - in case of error, 1 - in other case
+ */
+static int parse_relation(char *line, Set_list *set_list, Relation *relation)
+{
+    size_t length = strlen(line);
+    Line_scan scan;
+    if (!scan_line(&scan, line, length)){
+        return 0;
+    }
+
+    int success = 1;
+    size_t position = 0;
+    while (success && ((position = scan_find(&scan, position, 0, 0)) < length)){
+        if (line[position] != '('){
+            fprintf(error_output(), "Wrong syntax of input file!\n");
+            success = 0;
+            break;
+        }
+
+        /// First element of pair ends with space
+        size_t start = position + 1;
+        size_t end = scan_find(&scan, start, 1, 0);
+        if ((line[end] != ' ') || (end == start)){
+            fprintf(error_output(), "Wrong set element!\n");
+            success = 0;
             break;
         }
-        case SYMMETRIC:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!is_symmetric(relation_list, arg_1)){
-                return 0;
+        line[end] = '\0';
+        int first = element_index(set_list, line + start);
+        if (first < 0){
+            success = 0;
+            break;
+        }
+
+        /// Second element of pair ends with ')'
+        start = end + 1;
+        end = scan_find(&scan, start, 1, 1);
+        if ((line[end] != ')') || (end == start)){
+            fprintf(error_output(), "Wrong set element!\n");
+            success = 0;
+            break;
+        }
+        line[end] = '\0';
+        int second = element_index(set_list, line + start);
+
+        success = (second >= 0) && add_pair_to_relation(relation, first, second);
+        position = end + 1;
+    }
+    free_line_scan(&scan);
+
+    return success;
+}
+
+/// ======================================================================= ///
+
+/**
+ *  Function parses options given in file
+ *
+ * @param[in] file - pointer to filestream
+ * @param[in] line - buffer for line
+ * @param[in] rel_list
+ * @return 0 - in case of error, 1 - in other case
+ */
+static int read_relation(FILE *file, String_pool *line, Relation_list *relation_list, Set_list *set_list, int current_row)
+{
+    if (!read_definition_line(file, line)){
+        return 0;
+    }
+
+    Relation new_relation;
+    relation_ctor(&new_relation, current_row);
+
+    if (!parse_relation(line->data, set_list, &new_relation) || !build_adjacency(&new_relation, set_list) ||
+        !add_relation_to_list(relation_list, &new_relation)){
+        free_relation(&new_relation);
+        return 0;
+    }
+
+    print_relation(set_list, relation_list->relations[relation_list->size - 1]);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ *  Function parses options given in file.
+ *  Names of universe are stored in string pool of set list, elements of
+ *  other sets point to names of universe.
+ *
+ * @param[in] file - pointer to filestream
+ * @param[in] line - buffer for line
+ * @param[in] set_list
+ * @return 0 - in case of error, 1 - in other case
+ */
+static int read_set(FILE* file, String_pool *line, Set_list* set_list, int current_row)
+{
+    if (!read_definition_line(file, line)){
+        return 0;
+    }
+
+    Set new_set;
+    set_ctor(&new_set, current_row);
+
+    if (!parse_set(line->data, set_list, &new_set) || !prepare_set(set_list, &new_set) ||
+        !add_set_to_list(set_list, &new_set)){
+        free_set(&new_set);
+        return 0;
+    }
+    print_set(set_list, set_list->sets[set_list->size - 1]);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function parses one line of definition section in memory
+ *
+ * @param[in] definitions
+ * @param[in] i - index of line
+ * @return 0 - in case of error, 1 - in other case
+ */
+static int parse_definition(Definitions *definitions, int i)
+{
+    char *line = definitions->lines[i];
+    if (line[0] != ' ' && line[0] != '\n'){
+        fprintf(error_output(), "Wrong syntax of input file!\n");
+        return 0;
+    }
+
+    size_t length = strlen(line);
+    if (line[length - 1] == '\n'){
+        line[length - 1] = '\0';
+    }
+
+    Set_list *set_list = definitions->set_list;
+    int row = definitions->first_row + i;
+
+    if (definitions->kinds[i] == 'S'){
+        set_ctor(&definitions->sets[i], row);
+        return parse_set(line, set_list, &definitions->sets[i]) && prepare_set(set_list, &definitions->sets[i]);
+    }
+
+    relation_ctor(&definitions->relations[i], row);
+    return parse_relation(line, set_list, &definitions->relations[i]) &&
+           build_adjacency(&definitions->relations[i], set_list);
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function of thread parsing lines of definition section,
+ * lines are taken one by one until all of them are parsed.
+ * Error messages of wrong line are kept, so only the first wrong line
+ * is reported when rows are merged.
+ *
+ * @param[in] arg - definitions
+ * @return NULL
+ */
+static void *definitions_worker(void *arg)
+{
+    Definitions *definitions = (Definitions *) arg;
+    char *messages = NULL;
+    size_t size = 0;
+
+    /// Without stream messages are printed right away
+    error_file = open_memstream(&messages, &size);
+
+    while (1){
+        pthread_mutex_lock(&definitions->lock);
+        int i = definitions->next_line++;
+        pthread_mutex_unlock(&definitions->lock);
+
+        if (i >= definitions->number_of_lines){
+            break;
+        }
+        if (error_file != NULL){
+            fseek(error_file, 0, SEEK_SET);
+        }
+        definitions->parsed[i] = parse_definition(definitions, i);
+        if (definitions->parsed[i] || error_file == NULL){
+            continue;
+        }
+
+        fflush(error_file);
+        long length = ftell(error_file);
+        definitions->errors[i] = (char *) malloc(length + 1);
+        if (definitions->errors[i] == NULL){
+            fwrite(messages, 1, length, stderr);
+            continue;
+        }
+        memcpy(definitions->errors[i], messages, length);
+        definitions->errors[i][length] = '\0';
+    }
+
+    if (error_file != NULL){
+        fclose(error_file);
+        error_file = NULL;
+    }
+    free(messages);
+
+    return NULL;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function free resources for definition section
+ *
+ * @param[in] definitions
+ * @param[in] merged - number of lines already moved to lists
+ */
+static void free_definitions(Definitions *definitions, int merged)
+{
+    for (int i = 0; i < definitions->number_of_lines; i++){
+        free(definitions->lines[i]);
+        if (definitions->errors != NULL){
+            free(definitions->errors[i]);
+        }
+        if (i < merged){
+            continue;
+        }
+        if (definitions->kinds[i] == 'S'){
+            free_set(&definitions->sets[i]);
+        }
+        else {
+            free_relation(&definitions->relations[i]);
+        }
+    }
+    free(definitions->lines);
+    free(definitions->kinds);
+    free(definitions->sets);
+    free(definitions->relations);
+    free(definitions->parsed);
+    free(definitions->errors);
+    pthread_mutex_destroy(&definitions->lock);
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function appends line of definition section
+ *
+ * @param[in] definitions
+ * @param[in] kind - 'S' or 'R'
+ * @param[in] line - line without leading 'S' or 'R'
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int add_definition(Definitions *definitions, char kind, char *line)
+{
+    if (definitions->number_of_lines == definitions->capacity){
+        int capacity = definitions->capacity ? definitions->capacity * 2 : 16;
+        char **lines = (char **) realloc(definitions->lines, sizeof(char *) * capacity);
+        if (lines != NULL){
+            definitions->lines = lines;
+        }
+        char *kinds = (char *) realloc(definitions->kinds, capacity);
+        if (kinds != NULL){
+            definitions->kinds = kinds;
+        }
+        if (lines == NULL || kinds == NULL){
+            fprintf(stderr, "Not enough memory!\n");
+            return 0;
+        }
+        definitions->capacity = capacity;
+    }
+
+    definitions->lines[definitions->number_of_lines] = line;
+    definitions->kinds[definitions->number_of_lines] = kind;
+    definitions->number_of_lines++;
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function reads all consecutive lines of sets and relations from seekable
+ * file and parses them on multiple threads. Parsed rows are added to lists
+ * and printed in line order. File is left at the first line which isn't
+ * set or relation.
+ *
+ * @param[in] file
+ * @param[in] kind - 'S' or 'R' already read from the first line
+ * @param[in] set_list
+ * @param[in] relation_list
+ * @param[in] current_row - row of the first line, moved behind the last line
+ * @return 0 - in case of error, 1 - in other case
+ */
+static int read_definitions(FILE *file, char kind, Set_list *set_list, Relation_list *relation_list, int *current_row)
+{
+    Definitions definitions;
+    memset(&definitions, 0, sizeof(Definitions));
+    definitions.first_row = *current_row;
+    definitions.set_list = set_list;
+    pthread_mutex_init(&definitions.lock, NULL);
+
+    size_t bytes = 0;
+    int success = 1;
+    while (success){
+        char *line = NULL;
+        size_t size = 0;
+        ssize_t length = getline(&line, &size, file);
+        if (length < 0){
+            /// Option at the end of file is parsed as empty line, which is wrong syntax
+            free(line);
+            line = (char *) calloc(1, 1);
+            length = 0;
+        }
+        bytes += length;
+        success = line != NULL && add_definition(&definitions, kind, line);
+        if (!success){
+            free(line);
+            break;
+        }
+
+        /// Next line belongs to section only if it's set or relation within limit of rows
+        long position = ftell(file);
+        int c;
+        while (isblank(c = fgetc(file))){
+        }
+        if ((c != 'S' && c != 'R') || (definitions.first_row + definitions.number_of_lines > MAX_LINES)){
+            fseek(file, position, SEEK_SET);
+            break;
+        }
+        kind = (char) c;
+    }
+
+    int number_of_lines = definitions.number_of_lines;
+    definitions.sets = (Set *) calloc(number_of_lines, sizeof(Set));
+    definitions.relations = (Relation *) calloc(number_of_lines, sizeof(Relation));
+    definitions.parsed = (int *) calloc(number_of_lines, sizeof(int));
+    definitions.errors = (char **) calloc(number_of_lines, sizeof(char *));
+    if (success && (definitions.sets == NULL || definitions.relations == NULL ||
+                    definitions.parsed == NULL || definitions.errors == NULL)){
+        fprintf(stderr, "Not enough memory!\n");
+        success = 0;
+    }
+    if (!success){
+        definitions.number_of_lines = 0;
+        for (int i = 0; i < number_of_lines; i++){
+            free(definitions.lines[i]);
+        }
+        free_definitions(&definitions, 0);
+        return 0;
+    }
+
+    /// Small sections and sections of batch files are parsed by the calling thread only
+    long number_of_cpus = bytes >= PARALLEL_PARSE_BYTES && !batch_running ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    int number_of_threads = number_of_cpus > 0 ? (int) number_of_cpus : 1;
+    if (number_of_threads > number_of_lines){
+        number_of_threads = number_of_lines;
+    }
+
+    pthread_t threads[number_of_threads > 0 ? number_of_threads : 1];
+    int started = 1;
+    for (int i = 1; i < number_of_threads; i++){
+        if (pthread_create(&threads[i], NULL, definitions_worker, &definitions) != 0){
+            break;
+        }
+        started = i + 1;
+    }
+    definitions_worker(&definitions);
+    for (int i = 1; i < started; i++){
+        pthread_join(threads[i], NULL);
+    }
+
+    /// Rows are merged in line order, so the first wrong line stops loading like in sequential parsing
+    int merged = 0;
+    for (; merged < number_of_lines; merged++){
+        if (!definitions.parsed[merged]){
+            if (definitions.errors[merged] != NULL){
+                fputs(definitions.errors[merged], stderr);
             }
             break;
         }
-        case ANTISYMMETRIC:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
+        if (definitions.kinds[merged] == 'S'){
+            if (!add_set_to_list(set_list, &definitions.sets[merged])){
+                break;
             }
-            if (!is_antisymmetric(relation_list, arg_1)){
-                return 0;
+            print_set(set_list, set_list->sets[set_list->size - 1]);
+        }
+        else {
+            if (!add_relation_to_list(relation_list, &definitions.relations[merged])){
+                break;
             }
+            print_relation(set_list, relation_list->relations[relation_list->size - 1]);
+        }
+    }
+
+    free_definitions(&definitions, merged);
+    *current_row += merged;
+
+    return merged == number_of_lines;
+}
+
+/// ======================================================================= ///
+
+/**
+ *  Function parses options given in stream. Commands are executed as soon
+ *  as they are read, so stream doesn't have to be seekable. Sets and relations
+ *  of regular files are parsed in parallel.
+ *
+ * @param[in] file
+ * @return 0 - error, 1 - in other case
+ */
+static int process_input(FILE *file)
+{
+    Set_list set_list;
+    set_list_ctor(&set_list);
+
+    Relation_list relation_list;
+    relation_list_ctor(&relation_list);
+
+    int err_flag = 0;
+    int current_row = 1;
+
+    int universe_flag = 0;
+    int set_or_relation_flag = 0;
+    int read_command_flag = 0;
+    String_pool line;
+    pool_ctor(&line);
+    Command_plan plan;
+    plan_ctor(&plan);
+
+    struct stat info;
+    int seekable = (fstat(fileno(file), &info) == 0) && S_ISREG(info.st_mode);
+
+    int c;
+    while ((c = fgetc(file)) != EOF){
+
+        if (err_flag){
             break;
         }
-        case TRANSITIVE:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!is_transitive(relation_list, arg_1)){
-                return 0;
-            }
-            break;
+
+        if (isblank(c)){
+            continue;
         }
-        case FUNCTION:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!is_function(relation_list, arg_1)){
-                return 0;
-            }
+
+        if (current_row > MAX_LINES){
+            fprintf(stderr, "Input file is too long!");
+            err_flag = 1;
             break;
         }
-        case DOMAIN:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
-            }
-            if (!domain_or_codomain(relation_list, arg_1, 0)){
-                return 0;
+
+        switch (c) {
+            case 'U':{
+                if (universe_flag){
+                    fprintf(stderr, "Wrong syntax of input file!\n");
+                    err_flag = 1;
+                    break;
+                }
+                if (!read_set(file, &line, &set_list, current_row)){
+                    err_flag = 1;
+                }
+                universe_flag = 1;
+                current_row++;
+                break;
             }
-            break;
-        }
-        case CODOMAIN:{
-            if (arg_2){
-                fprintf(stderr, "Too many arguments!\n");
-                return 0;
+            case 'S':{
+                if (read_command_flag){
+                    fprintf(stderr, "Wrong syntax of input file!\n");
+                    err_flag = 1;
+                    break;
+                }
+                /// Line before universe is reported below
+                if (!universe_flag){
+                    break;
+                }
+                set_or_relation_flag = 1;
+                if (seekable){
+                    err_flag = !read_definitions(file, (char) c, &set_list, &relation_list, &current_row);
+                    break;
+                }
+                if (!read_set(file, &line, &set_list, current_row)){
+                    err_flag = 1;
+                }
+                current_row++;
+                break;
             }
-            if (!domain_or_codomain(relation_list, arg_1, 1)){
-                return 0;
+            case 'R':{
+                if (read_command_flag){
+                    fprintf(stderr, "Wrong syntax of input file!\n");
+                    err_flag = 1;
+                    break;
+                }
+                /// Line before universe is reported below
+                if (!universe_flag){
+                    break;
+                }
+                set_or_relation_flag = 1;
+                if (seekable){
+                    err_flag = !read_definitions(file, (char) c, &set_list, &relation_list, &current_row);
+                    break;
+                }
+                if (!read_relation(file, &line, &relation_list, &set_list, current_row)){
+                    err_flag = 1;
+                }
+                current_row++;
+                break;
             }
-            break;
-        }
-        case INJECTIVE:{
-            if (!arg_2 || !arg_3){
-                fprintf(stderr, "Too few arguments!\n");
-                return 0;
+            case 'C':{
+                /// Inverted index is built when all sets are loaded
+                if (!read_command_flag && universe_flag && !build_inverted_index(&set_list)){
+                    err_flag = 1;
+                    break;
+                }
+                if (!read_command(file, &line, &plan, &set_list, &relation_list)){
+                    err_flag = 1;
+                }
+                /// Next command of stream may not have arrived yet, so results aren't held back
+                if (!err_flag && !seekable && !flush_plan(&plan, &set_list)){
+                    err_flag = 1;
+                }
+                if (!check_record()){
+                    err_flag = 1;
+                }
+                read_command_flag = 1;
+                break;
             }
-            if (!is_injective(relation_list, set_list, arg_1, arg_2, arg_3)){
-                return 0;
+            default:{
+                fprintf(stderr, "Bad option.\n");
+                err_flag = 1;
             }
-            break;
         }
-        case SURJECTIVE:{
-            if (!arg_2 || !arg_3){
-                fprintf(stderr, "Too few arguments!\n");
-                return 0;
-            }
-            if (!is_surjective(relation_list, set_list, arg_1, arg_2, arg_3)){
-                return 0;
-            }
-            break;
+
+        if (!universe_flag){
+            fprintf(stderr, "Wrong syntax of input file!\n");
+            err_flag = 1;
         }
-        case BIJECTIVE:{
-            if (!arg_2 || !arg_3){
-                fprintf(stderr, "Too few arguments!\n");
-                return 0;
-            }
-            if (!is_bijective(relation_list, set_list, arg_1, arg_2, arg_3)){
-                return 0;
-            }
-            break;
+
+        if (read_command_flag && !set_or_relation_flag){
+            fprintf(stderr, "Wrong syntax of input file!\n");
+            err_flag = 1;
         }
-        default:{
-            fprintf(stderr, "Command %s doesn't exist\n", loaded_command);
+    }
+
+    if (!err_flag){
+        if (current_row <= 2){
+            fprintf(stderr, "Error: Only universe!\n");
+            err_flag = 1;
+        }
+        if (!read_command_flag){
+            fprintf(stderr, "No commands in input file!\n");
+            err_flag = 1;
+        }
+    }
+
+    /// Commands planned before end of file or error
+    if (!flush_plan(&plan, &set_list) || !check_record()){
+        err_flag = 1;
+    }
+
+    free_pool(&line);
+    free_record();
+    free_set_list(&set_list);
+    free_relation_list(&relation_list);
+
+    if (err_flag){
+        return 0;
+    }
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ *  Function parses options given in file, "-" reads standard input
+ *
+ * @param[in] filename
+ * @return 0 - error, 1 - in other case
+ */
+int setcal_read_option(char *filename)
+{
+    if (strcmp(filename, "-") == 0){
+        /// Results of piped commands are emitted line by line
+        struct stat info;
+        if ((fstat(fileno(stdin), &info) == 0) && !S_ISREG(info.st_mode)){
+            setvbuf(output(), NULL, _IOLBF, BUFSIZ);
+        }
+        return process_input(stdin);
+    }
+
+    FILE *file = fopen(filename, "r");
+
+    if (file == NULL){
+        fprintf(stderr, "Can't open %s.\n", filename);
+        return 0;
+    }
+
+    int result = process_input(file);
+    fclose(file);
+
+    return result;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function adds copy of path to list of files for batch mode
+ *
+ * @param[in] batch
+ * @param[in] path
+ * @return 0 - not enough memory, 1 - in other case
+ */
+static int add_file_to_batch(Batch *batch, const char *path)
+{
+    if (batch->number_of_files == batch->capacity){
+        batch->capacity = batch->capacity ? batch->capacity * 2 : 16;
+        char **temp = (char **) realloc(batch->files, sizeof(char *) * batch->capacity);
+        if (temp == NULL){
+            fprintf(stderr, "Not enough memory!\n");
+            return 0;
+        }
+        batch->files = temp;
+    }
+
+    batch->files[batch->number_of_files] = (char *) malloc(strlen(path) + 1);
+    if (batch->files[batch->number_of_files] == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return 0;
+    }
+    strcpy(batch->files[batch->number_of_files], path);
+    batch->number_of_files++;
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function adds all input files from directory to batch,
+ * hidden files and results of previous runs (*.out) are skipped
+ *
+ * @param[in] batch
+ * @param[in] dirname
+ * @return 0 - error, 1 - in other case
+ */
+static int add_directory_to_batch(Batch *batch, const char *dirname)
+{
+    DIR *dir = opendir(dirname);
+    if (dir == NULL){
+        fprintf(stderr, "Can't open %s.\n", dirname);
+        return 0;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL){
+        size_t length = strlen(entry->d_name);
+        if (entry->d_name[0] == '.' || (length > 4 && strcmp(entry->d_name + length - 4, ".out") == 0)){
+            continue;
+        }
+
+        char path[strlen(dirname) + length + 2];
+        sprintf(path, "%s/%s", dirname, entry->d_name);
+
+        struct stat info;
+        if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)){
+            continue;
+        }
+
+        if (!add_file_to_batch(batch, path)){
+            closedir(dir);
             return 0;
         }
     }
-    return 1;
+    closedir(dir);
+
+    return 1;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function free resources for batch
+ *
+ * @param[in] batch
+ */
+static void free_batch(Batch *batch)
+{
+    for (int i = 0; i < batch->number_of_files; i++){
+        free(batch->files[i]);
+    }
+    if (batch->files != NULL){
+        free(batch->files);
+        batch->files = NULL;
+    }
+    if (batch->deques != NULL){
+        for (int i = 0; i < batch->number_of_workers; i++){
+            pthread_mutex_destroy(&batch->deques[i].lock);
+            free(batch->deques[i].tasks);
+        }
+        free(batch->deques);
+        batch->deques = NULL;
+    }
+    batch->number_of_files = 0;
+    batch->capacity = 0;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function takes task for worker, first from the back of its own deque,
+ * then steals from the front of deques of other workers
+ *
+ * @param[in] batch
+ * @param[in] worker_id
+ * @return index of file, -1 if all deques are empty
+ */
+static int take_task(Batch *batch, int worker_id)
+{
+    Task_deque *own = &batch->deques[worker_id];
+    int task = -1;
+
+    pthread_mutex_lock(&own->lock);
+    if (own->head < own->tail){
+        own->tail--;
+        task = own->tasks[own->tail];
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    for (int i = 1; task < 0 && i < batch->number_of_workers; i++){
+        Task_deque *victim = &batch->deques[(worker_id + i) % batch->number_of_workers];
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->head < victim->tail){
+            task = victim->tasks[victim->head];
+            victim->head++;
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+
+    return task;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function of batch worker thread, processes files until all deques are empty,
+ * results of FILE are written to FILE.out
+ *
+ * @param[in] arg - pointer to Batch_worker
+ * @return NULL
+ */
+static void *batch_worker(void *arg)
+{
+    Batch_worker *worker = (Batch_worker *) arg;
+    Batch *batch = worker->batch;
+    int task;
+
+    while ((task = take_task(batch, worker->id)) >= 0){
+        char *filename = batch->files[task];
+        char out_name[strlen(filename) + 5];
+        sprintf(out_name, "%s.out", filename);
+
+        output_file = fopen(out_name, "w");
+        if (output_file == NULL){
+            fprintf(stderr, "Can't open %s.\n", out_name);
+            pthread_mutex_lock(&batch->lock);
+            batch->failures++;
+            pthread_mutex_unlock(&batch->lock);
+            continue;
+        }
+
+        int result = setcal_read_option(filename);
+        fclose(output_file);
+        output_file = NULL;
+
+        if (!result){
+            fprintf(stderr, "Error: Processing of %s failed\n", filename);
+            pthread_mutex_lock(&batch->lock);
+            batch->failures++;
+            pthread_mutex_unlock(&batch->lock);
+        }
+    }
+
+    return NULL;
 }
 
 /// ======================================================================= ///
 
 /**
- *  Function parses options given in file
+ * Function processes input files concurrently, arguments are files or directories
  *
- * @param[in] file - pointer to filestream
- * @param[in] rel_list
- * @return 0 - in case of error, 1 - in other case
+ * @param[in] argc
+ * @param[in] argv
+ * @return 0 - some file failed, 1 - in other case
  */
-int read_relation(FILE *file, Relation_list *relation_list, Set_list *set_list, int current_row)
+int setcal_run_batch(int argc, char **argv)
 {
-    char c = fgetc(file);
-    if (c != ' ' && c != '\n'){
-        fprintf(stderr, "Wrong syntax of input file!\n");
-        return 0;
-    }
-
-    Relation new_relation;
-    relation_ctor(&new_relation, current_row);
+    Batch batch = {NULL, 0, 0, NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER};
 
-    if (c == '\n'){
-        add_relation_to_list(relation_list, &new_relation);
-        print_relation(new_relation);
-        return 1;
-    }
-
-    while ((c = fgetc(file)) != '\n'){
-        if (isblank(c)){
-            continue;
-        }
-
-        if (c != '('){
-            fprintf(stderr, "Wrong syntax of input file!\n");
-            return 0;
+    for (int i = 0; i < argc; i++){
+        struct stat info;
+        int result;
+        if (stat(argv[i], &info) == 0 && S_ISDIR(info.st_mode)){
+            result = add_directory_to_batch(&batch, argv[i]);
         }
-
-        /// Read first element of pair
-        int index_elem_1 = 0;
-        char element_1[31];
-        while ((c = fgetc(file)) != ' '){
-            element_1[index_elem_1] = c;
-            index_elem_1++;
-            if (index_elem_1 > MAX_STRING_LENGTH){
-                fprintf(stderr, "Wrong set element!\n");
-                free_relation(&new_relation);
-                return 0;
-            }
+        else {
+            result = add_file_to_batch(&batch, argv[i]);
         }
-        element_1[index_elem_1] = '\0';
-        if (!is_element_in_universe(set_list, element_1)){
-            free_relation(&new_relation);
+        if (!result){
+            free_batch(&batch);
             return 0;
         }
+    }
 
-        /// Read second element of pair
-        int index_elem_2 = 0;
-        char element_2[31];
-        while ((c = fgetc(file)) != ')'){
-            element_2[index_elem_2] = c;
-            index_elem_2++;
-            if (index_elem_2 > MAX_STRING_LENGTH){
-                fprintf(stderr, "Wrong set element!\n");
-                free_relation(&new_relation);
-                return 0;
-            }
-        }
-        element_2[index_elem_2] = '\0';
-        if (!is_element_in_universe(set_list, element_2)){
-            free_relation(&new_relation);
-            return 0;
-        }
+    if (batch.number_of_files == 0){
+        fprintf(stderr, "No input files!\n");
+        free_batch(&batch);
+        return 0;
+    }
 
-        Pair new_pair;
-        pair_ctor(&new_pair);
+    long number_of_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    batch.number_of_workers = number_of_cpus > 0 ? (int) number_of_cpus : 1;
+    if (batch.number_of_workers > batch.number_of_files){
+        batch.number_of_workers = batch.number_of_files;
+    }
 
-        if (!add_elements_to_pair(&new_pair, element_1, element_2, index_elem_1, index_elem_2)){
-            free_pair(&new_pair);
-            return 0;
-        }
+    batch.deques = (Task_deque *) calloc(batch.number_of_workers, sizeof(Task_deque));
+    if (batch.deques == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        free_batch(&batch);
+        return 0;
+    }
 
-        if (find_pair(new_relation.pairs, new_pair, new_relation.number_of_pairs)){
-            fprintf(stderr, "Pair was already stored!\n");
-            free_pair(&new_pair);
-            free_relation(&new_relation);
+    /// Files are dealt to workers round robin, uneven sizes are handled by stealing
+    int per_worker = (batch.number_of_files + batch.number_of_workers - 1) / batch.number_of_workers;
+    for (int i = 0; i < batch.number_of_workers; i++){
+        pthread_mutex_init(&batch.deques[i].lock, NULL);
+        batch.deques[i].tasks = (int *) malloc(sizeof(int) * per_worker);
+        if (batch.deques[i].tasks == NULL){
+            fprintf(stderr, "Not enough memory!\n");
+            batch.number_of_workers = i + 1;
+            free_batch(&batch);
             return 0;
         }
+    }
+    for (int i = 0; i < batch.number_of_files; i++){
+        Task_deque *deque = &batch.deques[i % batch.number_of_workers];
+        deque->tasks[deque->tail++] = i;
+    }
 
-        if (!add_pair_to_relation(&new_relation, &new_pair)){
-            free_relation(&new_relation);
-            return 0;
+    pthread_t threads[batch.number_of_workers];
+    Batch_worker workers[batch.number_of_workers];
+    int started = 0;
+    batch_running = 1;
+    for (int i = 0; i < batch.number_of_workers; i++){
+        workers[i].batch = &batch;
+        workers[i].id = i;
+        if (i > 0 && pthread_create(&threads[i], NULL, batch_worker, &workers[i]) != 0){
+            break;
         }
+        started = i + 1;
     }
 
-    if (!add_relation_to_list(relation_list, &new_relation)){
-        free_relation(&new_relation);
-        return 0;
+    /// Main thread works too, tasks of workers that didn't start get stolen
+    batch_worker(&workers[0]);
+    for (int i = 1; i < started; i++){
+        pthread_join(threads[i], NULL);
     }
+    batch_running = 0;
 
-    print_relation(new_relation);
+    int failures = batch.failures;
+    free_batch(&batch);
 
-    return 1;
+    return failures == 0;
 }
 
 /// ======================================================================= ///
 
 /**
- *  Function parses options given in file
+ * Function switches printed results to binary records
  *
- * @param[in] file - pointer to filestream
- * @param[in] set_list
- * @return 0 - in case of error, 1 - in other case
+ * @param[in] binary 0 - text, 1 - binary
  */
-int read_set(FILE* file, Set_list* set_list, int current_row)
+void setcal_binary_output(int binary)
 {
-    char c = fgetc(file);
-    char element[32] = {0};
-    int elem_idx = 0;
-    int last_elem_idx;
+    binary_output = binary;
+}
 
-    Set new_set;
-    set_ctor(&new_set, current_row);
+/// ======================================================================= ///
 
-    if (c != ' ' && c != '\n'){
-        fprintf(stderr, "Wrong syntax of input file!\n");
-        return 0;
+/**
+ * Constructor for result of library call
+ *
+ * @param[in] result
+ */
+void setcal_result_ctor(Setcal_result *result)
+{
+    result->kind = RESULT_NONE;
+    result->elements = NULL;
+    result->size = 0;
+    result->capacity = 0;
+    result->value = 0;
+    result->text = NULL;
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function free resources for result of library call
+ *
+ * @param[in] result
+ */
+void free_setcal_result(Setcal_result *result)
+{
+    free(result->elements);
+    free(result->text);
+    setcal_result_ctor(result);
+}
+
+/// ======================================================================= ///
+
+/**
+ * Function free resources for calculator
+ *
+ * @param[in] setcal
+ */
+void free_setcal(Setcal *setcal)
+{
+    if (setcal == NULL){
+        return;
     }
+    free_set_list(&setcal->set_list);
+    free_relation_list(&setcal->relation_list);
+    free_pool(&setcal->line);
+    free(setcal);
+}
 
-    if (c == '\n'){
-        add_set_to_list(set_list, &new_set);
-        print_set(set_list, new_set);
-        return 1;
+/// ======================================================================= ///
+
+/**
+ * Constructor for calculator, universe is stored on the first row
+ *
+ * @param[in] universe - names of elements
+ * @param[in] size - number of elements
+ * @return new calculator, NULL - in case of error
+ */
+Setcal *setcal_ctor(char **universe, int size)
+{
+    Setcal *setcal = (Setcal *) malloc(sizeof(Setcal));
+    if (setcal == NULL){
+        fprintf(stderr, "Not enough memory!\n");
+        return NULL;
+    }
+    set_list_ctor(&setcal->set_list);
+    relation_list_ctor(&setcal->relation_list);
+    plan_ctor(&setcal->plan);
+    pool_ctor(&setcal->line);
+    setcal->rows = 1;
+
+    /// Names are copied into pool of universe like names read from file
+    String_pool *pool = &setcal->set_list.pool;
+    for (int i = 0; i < size; i++){
+        if (!check_element_syntax(universe[i]) || !pool_append(pool, universe[i])){
+            free_setcal(setcal);
+            return NULL;
+        }
     }
 
-    /// Read the first element from the file
-    fscanf(file, "%31s", element);
-    if (strlen(element) > MAX_STRING_LENGTH){
+    Set new_set;
+    set_ctor(&new_set, 1);
+    if (!add_pool_to_set(&new_set, pool) || !prepare_set(&setcal->set_list, &new_set) ||
+        !add_set_to_list(&setcal->set_list, &new_set)){
         free_set(&new_set);
-        fprintf(stderr, "Wrong set element!\n");
-        return 0;
+        free_setcal(setcal);
+        return NULL;
     }
-    last_elem_idx = strlen(element);
 
+    return setcal;
+}
 
-    while ((c = fgetc(file)) != '\n'){
-        if (isblank(c)){
-            elem_idx = 0;
-            continue;
-        }
+/// ======================================================================= ///
 
-        if (elem_idx == 0){
-            element[last_elem_idx] = '\0';
-            if (!(check_element_syntax(set_list, element))){
-                free_set(&new_set);
-                return 0;
-            }
-            if (!(add_element_to_set(&new_set, element, last_elem_idx))){
-                free_set(&new_set);
-                return 0;
-            }
-        }
+/**
+ * Function adds set on the next row of calculator
+ *
+ * @param[in] setcal
+ * @param[in] elements - names of elements
+ * @param[in] size - number of elements
+ * @return row of new set, 0 - in case of error
+ */
+int setcal_add_set(Setcal *setcal, char **elements, int size)
+{
+    if (setcal->rows >= MAX_LINES){
+        fprintf(stderr, "Too many rows!\n");
+        return 0;
+    }
+
+    Set new_set;
+    set_ctor(&new_set, setcal->rows + 1);
 
-        if (elem_idx >= MAX_STRING_LENGTH){
-            fprintf(stderr, "Wrong set element!\n");
+    for (int i = 0; i < size; i++){
+        char *name = universe_element(&setcal->set_list, elements[i]);
+        if (name == NULL || !(add_element_to_set(&new_set, name))){
             free_set(&new_set);
             return 0;
         }
-
-        element[elem_idx] = c;
-        elem_idx++;
-        last_elem_idx = elem_idx;
     }
 
-    /// Add last element to set
-    element[last_elem_idx] = '\0';
-    if (!(check_element_syntax(set_list, element))){
-        free_set(&new_set);
-        return 0;
-    }
-    if (!(add_element_to_set(&new_set, element, last_elem_idx))){
+    if (!prepare_set(&setcal->set_list, &new_set) || !add_set_to_list(&setcal->set_list, &new_set)){
         free_set(&new_set);
         return 0;
     }
 
-    add_set_to_list(set_list, &new_set);
-
-    /// Sort set elements in alphabetical order
-    qsort(new_set.elements, new_set.cardinality, sizeof(char *), str_comparator);
-    print_set(set_list, new_set);
+    /// New row is the last one, so it's appended to posting lists of its elements
+    Set_list *set_list = &setcal->set_list;
+    if (set_list->index.built){
+        Set *set = &set_list->sets[set_list->size - 1];
+        Set_cursor cursor;
+        set_cursor_ctor(&cursor, set);
+        int id;
+        while (set_cursor_next(&cursor, &id)){
+            if (!posting_append(&set_list->index.lists[id], set->position)){
+                /// Inverted index is built again before the next command
+                free_inverted_index(&set_list->index);
+                break;
+            }
+        }
+    }
 
-    return 1;
+    return ++setcal->rows;
 }
 
 /// ======================================================================= ///
 
 /**
- *  Function parses options given in file
+ * Function adds relation on the next row of calculator
  *
- * @param[in] filename
- * @return 0 - error, 1 - in other case
+ * @param[in] setcal
+ * @param[in] pairs - names of elements, first and second element of each pair
+ * @param[in] number_of_pairs
+ * @return row of new relation, 0 - in case of error
  */
-int read_option(char *filename)
+int setcal_add_relation(Setcal *setcal, char **pairs, int number_of_pairs)
 {
-    FILE *file = fopen(filename, "r");
-
-    if (file == NULL){
-        fprintf(stderr, "Can't open %s.\n", filename);
+    if (setcal->rows >= MAX_LINES){
+        fprintf(stderr, "Too many rows!\n");
         return 0;
     }
 
-    Set_list set_list;
-    set_list_ctor(&set_list);
-
-    Relation_list relation_list;
-    relation_list_ctor(&relation_list);
-
-    int err_flag = 0;
-    int current_row = 1;
-
-    int universe_flag = 0;
-    int set_or_relation_flag = 0;
-    int read_command_flag = 0;
-    char c;
-    while ((c = fgetc(file)) != EOF){
-
-        if (err_flag){
-            break;
-        }
+    Relation new_relation;
+    relation_ctor(&new_relation, setcal->rows + 1);
 
-        if (isblank(c)){
-            continue;
+    for (int i = 0; i < number_of_pairs; i++){
+        int first = element_index(&setcal->set_list, pairs[2 * i]);
+        int second = first >= 0 ? element_index(&setcal->set_list, pairs[2 * i + 1]) : -1;
+        if (second < 0 || !add_pair_to_relation(&new_relation, first, second)){
+            free_relation(&new_relation);
+            return 0;
         }
+    }
 
-        if (current_row > MAX_LINES){
-            fprintf(stderr, "Input file is too long!");
-            err_flag = 1;
-            break;
-        }
+    if (!build_adjacency(&new_relation, &setcal->set_list) ||
+        !add_relation_to_list(&setcal->relation_list, &new_relation)){
+        free_relation(&new_relation);
+        return 0;
+    }
 
-        switch (c) {
-            case 'U':{
-                if (universe_flag){
-                    fprintf(stderr, "Wrong syntax of input file!\n");
-                    err_flag = 1;
-                    break;
-                }
-                if (!read_set(file, &set_list, current_row)){
-                    err_flag = 1;
-                }
-                universe_flag = 1;
-                current_row++;
-                break;
-            }
-            case 'S':{
-                if (read_command_flag){
-                    fprintf(stderr, "Wrong syntax of input file!\n");
-                    err_flag = 1;
-                    break;
-                }
-                if (!read_set(file, &set_list, current_row)){
-                    err_flag = 1;
-                }
-                set_or_relation_flag = 1;
-                current_row++;
-                break;
-            }
-            case 'R':{
-                if (read_command_flag){
-                    fprintf(stderr, "Wrong syntax of input file!\n");
-                    err_flag = 1;
-                    break;
-                }
-                if (!read_relation(file, &relation_list, &set_list, current_row)){
-                    err_flag = 1;
-                }
-                set_or_relation_flag = 1;
-                current_row++;
-                break;
-            }
-            case 'C':{
-                if (!read_command(file, &set_list, &relation_list)){
-                    err_flag = 1;
-                }
-                read_command_flag = 1;
-                break;
-            }
-            default:{
-                fprintf(stderr, "Bad option.\n");
-                err_flag = 1;
-            }
-        }
+    return ++setcal->rows;
+}
 
-        if (!universe_flag){
-            fprintf(stderr, "Wrong syntax of input file!\n");
-            err_flag = 1;
-        }
+/// ======================================================================= ///
 
-        if (read_command_flag && !set_or_relation_flag){
-            fprintf(stderr, "Wrong syntax of input file!\n");
-            err_flag = 1;
-        }
+/**
+ * Function executes one command of calculator, its result is stored
+ * in structure instead of being printed
+ *
+ * @param[in] setcal
+ * @param[in] command - command line without leading 'C'
+ * @param[out] result
+ * @return 0 - command was wrong or its result couldn't be stored, 1 - in other case
+ */
+int setcal_run(Setcal *setcal, const char *command, Setcal_result *result)
+{
+    /// Command is tokenized in place, so it's copied first
+    setcal->line.size = 0;
+    if (!pool_append(&setcal->line, command)){
+        return 0;
     }
 
-    if (!err_flag){
-        if (current_row <= 2){
-            fprintf(stderr, "Error: Only universe!\n");
-            err_flag = 1;
-        }
-        if (!read_command_flag){
-            fprintf(stderr, "No commands in input file!\n");
-            err_flag = 1;
-        }
+    if (!setcal->set_list.index.built && !build_inverted_index(&setcal->set_list)){
+        return 0;
     }
 
-    free_set_list(&set_list);
-    free_relation_list(&relation_list);
-    fclose(file);
+    result->kind = RESULT_NONE;
+    result->size = 0;
+    result->value = 0;
+
+    /// Capacity of text of previous result isn't known, so text is allocated again
+    free(result->text);
+    result->text = NULL;
+
+    capture.result = result;
+    capture.length = 0;
+    capture.capacity = 0;
+    capture.failed = 0;
+    int success = run_command(setcal->line.data, &setcal->plan, &setcal->set_list, &setcal->relation_list);
+    if (!flush_plan(&setcal->plan, &setcal->set_list) || capture.failed){
+        success = 0;
+    }
+    capture.result = NULL;
 
-    if (err_flag){
-        return 0;
+    if (result->kind == RESULT_TEXT && capture.length > 0 && result->text[capture.length - 1] == '\n'){
+        result->text[capture.length - 1] = '\0';
     }
 
-    return 1;
+    return success;
 }
 
 /// ======================================================================= ///
 
-int main(int argc, char **argv)
+/**
+ * Function returns name of element of universe
+ *
+ * @param[in] setcal
+ * @param[in] index - index of element in alphabetically sorted universe
+ * @return name of element, NULL - index is out of range
+ */
+const char *setcal_element(Setcal *setcal, int index)
 {
-    if (argc != 2){
-        fprintf(stderr, "Wrong number of arguments!\n");
-        return EXIT_FAILURE;
-    }
-
-    if (!read_option(argv[1])){
-        return EXIT_FAILURE;
+    if (index < 0 || index >= setcal->set_list.sets[0].cardinality){
+        return NULL;
     }
 
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    return setcal->set_list.sets[0].elements[index];
+}
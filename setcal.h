@@ -0,0 +1,95 @@
+/**
+ * @name setcal.h
+ * @details interface of set and relation calculator library (libsetcal)
+ * @authors Marian Taragel, Georgii Troitckii, Tomas Prokop
+ * @date 4.12.2021
+ */
+
+#ifndef SETCAL_H
+#define SETCAL_H
+
+/// Kinds of results returned by setcal_run
+enum result_kinds {RESULT_NONE, RESULT_SET, RESULT_RELATION, RESULT_BOOL, RESULT_NUMBER, RESULT_TEXT};
+
+/// Universe with its sets and relations, rows are numbered as in input file
+typedef struct setcal Setcal;
+
+typedef struct{
+    int kind;
+    int* elements;              /// indexes to universe, pairs are stored as first and second index
+    int size;                   /// number of elements of set or pairs of relation
+    int capacity;
+    unsigned long long value;   /// boolean or number
+    char* text;                 /// other results, e.g. profile or similarity
+} Setcal_result;
+
+/**
+ * Function creates calculator with universe on the first row
+ *
+ * @param[in] universe - names of elements
+ * @param[in] size - number of elements
+ * @return new calculator, NULL - in case of error
+ */
+Setcal *setcal_ctor(char **universe, int size);
+
+/**
+ * Function free resources for calculator
+ *
+ * @param[in] setcal
+ */
+void free_setcal(Setcal *setcal);
+
+/**
+ * Function adds set on the next row
+ *
+ * @param[in] setcal
+ * @param[in] elements - names of elements
+ * @param[in] size - number of elements
+ * @return row of new set, 0 - in case of error
+ */
+int setcal_add_set(Setcal *setcal, char **elements, int size);
+
+/**
+ * Function adds relation on the next row
+ *
+ * @param[in] setcal
+ * @param[in] pairs - names of elements, first and second element of each pair
+ * @param[in] number_of_pairs
+ * @return row of new relation, 0 - in case of error
+ */
+int setcal_add_relation(Setcal *setcal, char **pairs, int number_of_pairs);
+
+/**
+ * Function executes one command, e.g. "union 2 3" or "transitive 4"
+ *
+ * @param[in] setcal
+ * @param[in] command - command line without leading 'C'
+ * @param[out] result
+ * @return 0 - command was wrong or its result couldn't be stored, 1 - in other case
+ */
+int setcal_run(Setcal *setcal, const char *command, Setcal_result *result);
+
+/**
+ * Function returns name of element of universe
+ *
+ * @param[in] setcal
+ * @param[in] index - index of element in alphabetically sorted universe
+ * @return name of element, NULL - index is out of range
+ */
+const char *setcal_element(Setcal *setcal, int index);
+
+/**
+ * Constructor for result
+ *
+ * @param[in] result
+ */
+void setcal_result_ctor(Setcal_result *result);
+
+/**
+ * Function free resources for result
+ *
+ * @param[in] result
+ */
+void free_setcal_result(Setcal_result *result);
+
+#endif
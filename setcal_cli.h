@@ -0,0 +1,39 @@
+/**
+ * @name setcal_cli.h
+ * @details entry points of libsetcal used by command line interface (main.c),
+ *          they aren't part of library interface
+ * @authors Marian Taragel, Georgii Troitckii, Tomas Prokop
+ * @date 4.12.2021
+ */
+
+#ifndef SETCAL_CLI_H
+#define SETCAL_CLI_H
+
+#include "setcal.h"
+
+/**
+ * Function switches results printed by setcal_read_option and setcal_run_batch to binary records
+ *
+ * @param[in] binary 0 - text, 1 - binary
+ */
+void setcal_binary_output(int binary);
+
+/**
+ *  Function parses options given in file, "-" reads standard input
+ *
+ * @param[in] filename
+ * @return 0 - error, 1 - in other case
+ */
+int setcal_read_option(char *filename);
+
+/**
+ * Function processes input files (or directories) in parallel,
+ * results of FILE are written to FILE.out
+ *
+ * @param[in] argc - number of files
+ * @param[in] argv - files
+ * @return 0 - some file failed, 1 - in other case
+ */
+int setcal_run_batch(int argc, char **argv);
+
+#endif